@@ -1,5 +1,5 @@
 import { bench, run, group } from 'mitata'
-import { RocksLevel } from '../index.js'
+import { RocksLevel, PackedValues } from '../index.js'
 
 const db = new RocksLevel('./tmp', {
   keyEncoding: 'buffer',
@@ -29,6 +29,20 @@ const getUnsafeOpts = {
   unsafe: true
 }
 
+const getPackedOpts = {
+  valueEncoding: 'buffer',
+  fillCache: true,
+  format: 'packed'
+}
+
+const getPackedIntoOpts = {
+  valueEncoding: 'buffer',
+  fillCache: true,
+  format: 'packed',
+  buffer: Buffer.allocUnsafe(1024 * 256 * 1024),
+  offsets: new Uint32Array(PackedValues.indexLength(1024))
+}
+
 for (let size = 1024; size <= 256 * 1024; size *= 2) {
   const keys = []
   for (let n = 0; n < 1024; n++) {
@@ -46,6 +60,14 @@ for (let size = 1024; size <= 256 * 1024; size *= 2) {
     bench('_getManySync ' + size / 1024 + ' unsafe', () => {
       db._getManySync(keys, getUnsafeOpts)
     })
+
+    bench('_getManySync ' + size / 1024 + ' packed', () => {
+      db._getManySync(keys, getPackedOpts)
+    })
+
+    bench('_getManySync ' + size / 1024 + ' packed into', () => {
+      db._getManySync(keys, getPackedIntoOpts)
+    })
   })
 }
 
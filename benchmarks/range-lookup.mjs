@@ -0,0 +1,82 @@
+import { bench, run, group } from 'mitata'
+import { RocksLevel } from '../index.js'
+
+// Compares short range scans on the default profile and on
+// `optimize: 'range-lookup'`, over data compacted into SST files.
+
+const TENANTS = 1024
+const ROWS = 256
+
+async function open (location, options) {
+  const db = new RocksLevel(location, {
+    keyEncoding: 'utf8',
+    valueEncoding: 'buffer',
+    columns: {
+      default: {
+        cacheSize: 32e6,
+        memtableMemoryBudget: 64e6,
+        compaction: 'level',
+        prefixExtractor: 'rocksdb.FixedPrefix.9',
+        ...options
+      }
+    }
+  })
+  await db.open()
+
+  for (let tenant = 0; tenant < TENANTS; tenant++) {
+    const batch = []
+    for (let row = 0; row < ROWS; row++) {
+      batch.push({ type: 'put', key: key(tenant, row), value: Buffer.alloc(128, row) })
+    }
+    await db.batch(batch)
+  }
+  await db.compactRange()
+
+  return db
+}
+
+function key (tenant, row) {
+  return `${String(tenant).padStart(8, '0')}-${String(row).padStart(8, '0')}`
+}
+
+function prefix (tenant) {
+  return `${String(tenant).padStart(8, '0')}-`
+}
+
+const dbs = {
+  default: await open('./tmp-default', {}),
+  'range-lookup': await open('./tmp-range-lookup', { optimize: 'range-lookup' })
+}
+
+let n = 0
+function next () {
+  n = (n * 7919 + 1) % TENANTS
+  return n
+}
+
+for (const [name, db] of Object.entries(dbs)) {
+  group(name, () => {
+    bench('querySync 16 rows', () => {
+      const tenant = next()
+      db.querySync({ gte: key(tenant, 100), lt: key(tenant, 116) })
+    })
+
+    bench('querySync prefix', () => {
+      db.querySync({ prefix: prefix(next()) })
+    })
+
+    bench('iterator prefix', async () => {
+      await db.iterator({ prefix: prefix(next()) }).all()
+    })
+
+    bench('querySync missing prefix', () => {
+      db.querySync({ prefix: prefix(TENANTS + next()) })
+    })
+  })
+}
+
+await run()
+
+for (const db of Object.values(dbs)) {
+  await db.close()
+}
@@ -16,19 +16,28 @@
 #include <rocksdb/slice_transform.h>
 #include <rocksdb/status.h>
 #include <rocksdb/table.h>
+#include <rocksdb/utilities/optimistic_transaction_db.h>
+#include <rocksdb/utilities/transaction.h>
+#include <rocksdb/utilities/write_batch_with_index.h>
 #include <rocksdb/write_batch.h>
 
 #include <re2/re2.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "json_predicate.h"
 #include "max_rev_operator.h"
 #include "util.h"
 
@@ -36,12 +45,18 @@ enum ResourceName {
   ResourceIteratorNextv = 0,
   ResourceLeveldownOpen,
   ResourceLeveldownClose,
+  ResourceLeveldownGet,
   ResourceLeveldownGetMany,
   ResourceLeveldownFlushWal,
   ResourceLeveldownIteratorSeek,
   ResourceLeveldownBatchWrite,
   ResourceLeveldownUpdatesSince,
   ResourceLeveldownCompactRange,
+  ResourceLeveldownCount,
+  ResourceLeveldownQueryMany,
+  ResourceLeveldownGetNearest,
+  ResourceLeveldownTransactionCommit,
+  ResourceLeveldownPutIfNewer,
   ResourceNameCount
 };
 
@@ -66,6 +81,163 @@ struct Closable {
   virtual rocksdb::Status Close() = 0;
 };
 
+// Idle rocksdb iterators over the latest state, kept per column family (and
+// per combination of bounds) so that short reads can refresh and re-bound one
+// instead of constructing a new iterator each time. Only iterators created
+// with Defaults() read options are pooled. An idle iterator still references
+// the memtables and files it last saw, so at most kCapacity of each kind are
+// kept. Those idle for longer than the idle timeout are dropped, from every
+// kind, whenever the pool is used.
+class IteratorPool {
+ public:
+  static constexpr size_t kCapacity = 8;
+  static constexpr std::chrono::milliseconds kIdleTimeout{10000};
+
+  // Referenced by the read options of a pooled iterator, so that its bounds
+  // can be replaced before it is reused.
+  struct Bounds {
+    std::string lowerData;
+    std::string upperData;
+    rocksdb::Slice lower;
+    rocksdb::Slice upper;
+  };
+
+  struct Entry {
+    std::unique_ptr<rocksdb::Iterator> iterator;
+    std::shared_ptr<Bounds> bounds;
+    bool lower = false;
+    bool upper = false;
+    std::chrono::steady_clock::time_point idleSince;
+  };
+
+  // Matches the defaults of iterator options (see Iterator::create).
+  static rocksdb::ReadOptions Defaults() {
+    rocksdb::ReadOptions readOptions;
+    readOptions.background_purge_on_iterator_cleanup = true;
+    readOptions.fill_cache = false;
+    readOptions.async_io = true;
+    readOptions.adaptive_readahead = true;
+    readOptions.auto_readahead_size = true;
+    return readOptions;
+  }
+
+  // Whether an iterator with these options (ignoring bounds) can be pooled.
+  static bool Poolable(const rocksdb::ReadOptions& readOptions) {
+    const auto defaults = Defaults();
+    return !readOptions.snapshot && !readOptions.pin_data && !readOptions.tailing &&
+           readOptions.background_purge_on_iterator_cleanup == defaults.background_purge_on_iterator_cleanup &&
+           readOptions.fill_cache == defaults.fill_cache && readOptions.async_io == defaults.async_io &&
+           readOptions.adaptive_readahead == defaults.adaptive_readahead &&
+           readOptions.readahead_size == defaults.readahead_size &&
+           readOptions.auto_readahead_size == defaults.auto_readahead_size &&
+           readOptions.ignore_range_deletions == defaults.ignore_range_deletions &&
+           readOptions.total_order_seek == defaults.total_order_seek &&
+           readOptions.auto_prefix_mode == defaults.auto_prefix_mode &&
+           readOptions.prefix_same_as_start == defaults.prefix_same_as_start;
+  }
+
+  // An unpositioned iterator over the latest state of `column`, restricted to
+  // [lower, upper) where given.
+  Entry Acquire(rocksdb::DB* db,
+                rocksdb::ColumnFamilyHandle* column,
+                const rocksdb::Slice* lower = nullptr,
+                const rocksdb::Slice* upper = nullptr) {
+    Entry entry;
+    std::vector<Entry> expired;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Evict(expired);
+      auto& idle = idle_[{column, lower != nullptr, upper != nullptr}];
+      if (!idle.empty()) {
+        entry = std::move(idle.back());
+        idle.pop_back();
+      }
+    }
+
+    if (entry.iterator) {
+      SetBounds(*entry.bounds, lower, upper);
+      if (entry.iterator->Refresh().ok()) {
+        return entry;
+      }
+      entry = Entry();
+    }
+
+    entry.bounds = std::make_shared<Bounds>();
+    entry.lower = lower != nullptr;
+    entry.upper = upper != nullptr;
+    SetBounds(*entry.bounds, lower, upper);
+
+    auto readOptions = Defaults();
+    readOptions.iterate_lower_bound = lower ? &entry.bounds->lower : nullptr;
+    readOptions.iterate_upper_bound = upper ? &entry.bounds->upper : nullptr;
+    entry.iterator.reset(db->NewIterator(readOptions, column));
+
+    return entry;
+  }
+
+  void Release(rocksdb::ColumnFamilyHandle* column, Entry entry) {
+    std::vector<Entry> expired;
+    std::lock_guard<std::mutex> lock(mutex_);
+    Evict(expired);
+    auto& idle = idle_[{column, entry.lower, entry.upper}];
+    if (idle.size() < kCapacity && entry.iterator->status().ok()) {
+      entry.idleSince = std::chrono::steady_clock::now();
+      idle.push_back(std::move(entry));
+    }
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.clear();
+  }
+
+  void SetIdleTimeout(std::chrono::milliseconds idleTimeout) { idleTimeout_ = idleTimeout; }
+
+  // The number of idle iterators, for tests.
+  size_t Size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t size = 0;
+    for (const auto& [key, idle] : idle_) {
+      size += idle.size();
+    }
+    return size;
+  }
+
+ private:
+  using Key = std::tuple<rocksdb::ColumnFamilyHandle*, bool, bool>;
+
+  static void SetBounds(Bounds& bounds, const rocksdb::Slice* lower, const rocksdb::Slice* upper) {
+    if (lower) {
+      bounds.lowerData.assign(lower->data(), lower->size());
+      bounds.lower = bounds.lowerData;
+    }
+    if (upper) {
+      bounds.upperData.assign(upper->data(), upper->size());
+      bounds.upper = bounds.upperData;
+    }
+  }
+
+  // Moves entries idle for too long (the oldest are at the front of each
+  // kind) to `expired`, to be destroyed by the caller outside the lock.
+  void Evict(std::vector<Entry>& expired) {
+    const auto deadline = std::chrono::steady_clock::now() - idleTimeout_;
+    for (auto it = idle_.begin(); it != idle_.end();) {
+      auto& idle = it->second;
+      auto end = idle.begin();
+      while (end != idle.end() && end->idleSince < deadline) {
+        ++end;
+      }
+      std::move(idle.begin(), end, std::back_inserter(expired));
+      idle.erase(idle.begin(), end);
+      it = idle.empty() ? idle_.erase(it) : std::next(it);
+    }
+  }
+
+  std::mutex mutex_;
+  std::map<Key, std::vector<Entry>> idle_;
+  std::chrono::milliseconds idleTimeout_ = kIdleTimeout;
+};
+
 struct Database final {
   Database(std::string location) : location(std::move(location)) {}
   ~Database() { assert(!db); }
@@ -75,27 +247,32 @@ struct Database final {
       return rocksdb::Status::OK();
     }
 
-    std::set<Closable*> closables;
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      closables = std::move(closables_);
+    if (*pins > 0) {
+      // Buffers from pinData iterators still reference blocks of this DB, and
+      // closing it would leave them dangling. Refused before anything else is
+      // closed, so the db stays fully usable until they are freed.
+      return rocksdb::Status::Busy("Cannot close while pinned iterator buffers are alive");
     }
 
-    for (auto closable : closables) {
-      closable->Close();
-    }
+    CloseResources();
 
     db->FlushWAL(true);
 
-    for (auto& [id, column] : columns) {
-      db->DestroyColumnFamilyHandle(column.handle);
-    }
-    columns.clear();
-
     auto db2 = std::move(db);
     return db2->Close();
   }
 
+  // For teardown, when Close() cannot wait for pinned buffers: hands the DB
+  // over to them, to be closed by its destructor once the last one is freed.
+  // Their iterators hold their own reference to the column family data, so
+  // the handles can go now.
+  void Abandon() {
+    if (Close().IsBusy()) {
+      CloseResources();
+      db.reset();
+    }
+  }
+
   void Attach(Closable* closable) {
     std::lock_guard<std::mutex> lock(mutex_);
 
@@ -108,10 +285,29 @@ struct Database final {
     closables_.erase(closable);
   }
 
+  // The prefix extractor configured for `column`, if any.
+  const rocksdb::SliceTransform* PrefixExtractor(rocksdb::ColumnFamilyHandle* column) const {
+    const auto it = columns.find(column->GetID());
+    return it != columns.end() ? it->second.descriptor.options.prefix_extractor.get() : prefixExtractor.get();
+  }
+
   const std::string location;
 
-  std::unique_ptr<rocksdb::DB> db;
+  // Shared with iterators whose pinned blocks back unsafe buffers, so that the
+  // DB outlives them (see BaseIterator::Pin).
+  std::shared_ptr<rocksdb::DB> db;
+  // `db`, when opened with optimisticTransactions.
+  rocksdb::OptimisticTransactionDB* optimistic = nullptr;
   std::map<int32_t, ColumnFamily> columns;
+  // Of the default column, when it is not in `columns`.
+  std::shared_ptr<const rocksdb::SliceTransform> prefixExtractor;
+  IteratorPool iterators;
+  // The number of live buffers pinning iterator data. Shared with them, as
+  // they can outlive this.
+  std::shared_ptr<std::atomic<size_t>> pins = std::make_shared<std::atomic<size_t>>(0);
+  // Striped by key hash. Serializes putIfNewer() read-compare-writes of the
+  // same key; other writes do not take them.
+  std::array<std::mutex, 64> revLocks;
   napi_ref resourceNamesRef = nullptr;
 
   static napi_status InitResourceNames(napi_env env, Database* db) {
@@ -127,12 +323,18 @@ struct Database final {
     NAPI_STATUS_RETURN(set(ResourceIteratorNextv, "iterator.nextv"));
     NAPI_STATUS_RETURN(set(ResourceLeveldownOpen, "leveldown.open"));
     NAPI_STATUS_RETURN(set(ResourceLeveldownClose, "leveldown.close"));
+    NAPI_STATUS_RETURN(set(ResourceLeveldownGet, "leveldown.get"));
     NAPI_STATUS_RETURN(set(ResourceLeveldownGetMany, "leveldown.get_many"));
     NAPI_STATUS_RETURN(set(ResourceLeveldownFlushWal, "leveldown.flush_wal"));
     NAPI_STATUS_RETURN(set(ResourceLeveldownIteratorSeek, "leveldown.iterator_seek"));
     NAPI_STATUS_RETURN(set(ResourceLeveldownBatchWrite, "leveldown.batch_write"));
+    NAPI_STATUS_RETURN(set(ResourceLeveldownTransactionCommit, "leveldown.transaction_commit"));
+    NAPI_STATUS_RETURN(set(ResourceLeveldownPutIfNewer, "leveldown.put_if_newer"));
     NAPI_STATUS_RETURN(set(ResourceLeveldownUpdatesSince, "leveldown.updates_since"));
     NAPI_STATUS_RETURN(set(ResourceLeveldownCompactRange, "leveldown.compact_range"));
+    NAPI_STATUS_RETURN(set(ResourceLeveldownCount, "leveldown.count"));
+    NAPI_STATUS_RETURN(set(ResourceLeveldownQueryMany, "leveldown.query_many"));
+    NAPI_STATUS_RETURN(set(ResourceLeveldownGetNearest, "leveldown.get_nearest"));
 
     NAPI_STATUS_RETURN(napi_create_reference(env, array, 1, &db->resourceNamesRef));
     return napi_ok;
@@ -146,10 +348,142 @@ struct Database final {
   }
 
  private:
+  // Closes open snapshots, transactions and iterators, then the column handles.
+  void CloseResources() {
+    std::set<Closable*> closables;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closables = std::move(closables_);
+    }
+
+    for (auto closable : closables) {
+      closable->Close();
+    }
+
+    iterators.Clear();
+
+    for (auto& [id, column] : columns) {
+      db->DestroyColumnFamilyHandle(column.handle);
+    }
+    columns.clear();
+
+    optimistic = nullptr;
+  }
+
   mutable std::mutex mutex_;
   std::set<Closable*> closables_;
 };
 
+// A consistent read view for db.snapshot(). Released by close(), when the
+// database closes or once garbage collected; reads that are still using it
+// share ownership until they complete.
+struct Snapshot final : public Closable {
+  Snapshot(Database* database) : database_(database) {
+    snapshot_ = std::shared_ptr<const rocksdb::Snapshot>(
+        database->db->GetSnapshot(),
+        [db = database->db](const rocksdb::Snapshot* snapshot) { db->ReleaseSnapshot(snapshot); });
+    database_->Attach(this);
+  }
+
+  virtual ~Snapshot() {
+    if (snapshot_) {
+      database_->Detach(this);
+    }
+  }
+
+  rocksdb::Status Close() override {
+    if (snapshot_) {
+      snapshot_.reset();
+      database_->Detach(this);
+    }
+    return rocksdb::Status::OK();
+  }
+
+  Database* database_;
+  std::shared_ptr<const rocksdb::Snapshot> snapshot_;
+};
+
+// A closed snapshot is rejected rather than silently reading the latest state.
+static napi_status GetValue(napi_env env, napi_value value, Snapshot*& result) {
+  NAPI_STATUS_RETURN(napi_get_value_external(env, value, reinterpret_cast<void**>(&result)));
+  return result->snapshot_ ? napi_ok : napi_invalid_arg;
+}
+
+// The view of an optional `snapshot` option, to be kept alive while reading.
+static napi_status GetSnapshot(napi_env env,
+                               napi_value options,
+                               rocksdb::ReadOptions& readOptions,
+                               std::shared_ptr<const rocksdb::Snapshot>& result) {
+  Snapshot* snapshot = nullptr;
+  NAPI_STATUS_RETURN(GetProperty(env, options, "snapshot", snapshot));
+  if (snapshot) {
+    result = snapshot->snapshot_;
+    readOptions.snapshot = result.get();
+  }
+  return napi_ok;
+}
+
+// An optimistic transaction for db.transaction(). Writes are buffered until
+// Commit(), which fails with Busy if a key read by GetForUpdate() was written
+// by someone else in the meantime, or TryAgain if that can no longer be told.
+// Rolled back if closed before that.
+struct Transaction final : public Closable {
+  Transaction(Database* database, const rocksdb::WriteOptions& writeOptions, const bool snapshot)
+      : database_(database) {
+    rocksdb::OptimisticTransactionOptions options;
+    options.set_snapshot = snapshot;
+    transaction_.reset(database->optimistic->BeginTransaction(writeOptions, options));
+    database_->Attach(this);
+  }
+
+  virtual ~Transaction() {
+    if (transaction_) {
+      database_->Detach(this);
+    }
+  }
+
+  rocksdb::Status Close() override {
+    if (transaction_) {
+      transaction_.reset();
+      database_->Detach(this);
+    }
+    return rocksdb::Status::OK();
+  }
+
+  Database* database_;
+  std::unique_ptr<rocksdb::Transaction> transaction_;
+};
+
+static napi_status GetValue(napi_env env, napi_value value, Transaction*& result) {
+  NAPI_STATUS_RETURN(napi_get_value_external(env, value, reinterpret_cast<void**>(&result)));
+  return result->transaction_ ? napi_ok : napi_invalid_arg;
+}
+
+// A batch held by JS. Writes go through `base`, which for an indexed batch is
+// a rocksdb::WriteBatchWithIndex (`indexed`) so that reads through the batch
+// see them merged with the DB. Iterators reading through it share ownership.
+struct Batch {
+  Batch() : base(std::make_shared<rocksdb::WriteBatch>()) {}
+
+  // Keys of the default column are ordered by `comparator` (those of other
+  // columns by the comparator of their handle).
+  explicit Batch(const rocksdb::Comparator* comparator)
+      : indexed(std::make_shared<rocksdb::WriteBatchWithIndex>(comparator, 0, true)) {
+    base = indexed;
+  }
+
+  rocksdb::WriteBatch* Get() { return base->GetWriteBatch(); }
+
+  std::shared_ptr<rocksdb::WriteBatchBase> base;
+  std::shared_ptr<rocksdb::WriteBatchWithIndex> indexed;
+};
+
+// Only indexed batches can be read through.
+static napi_status GetValue(napi_env env, napi_value value, Batch*& result) {
+  NAPI_STATUS_RETURN(napi_get_value_external(env, value, reinterpret_cast<void**>(&result)));
+  return result->indexed ? napi_ok : napi_invalid_arg;
+}
+
 enum BatchOp { Empty, Put, Delete, Merge, Data };
 
 struct BatchEntry {
@@ -323,6 +657,263 @@ struct BatchIterator : public rocksdb::WriteBatch::Handler {
   std::vector<BatchEntry> cache_;
 };
 
+// A key or value filter made of one or more patterns, any of which may match.
+// Patterns without regex syntax (other than a leading ^ or trailing $) are
+// compared directly; the rest are compiled into a single RE2::Set.
+class Filter {
+  struct Literal {
+    std::string text;
+    bool start;
+    bool end;
+  };
+
+ public:
+  explicit Filter(const std::vector<std::string>& patterns) {
+    for (const auto& pattern : patterns) {
+      if (auto literal = ParseLiteral(pattern)) {
+        literals_.push_back(std::move(*literal));
+        continue;
+      }
+
+      if (!set_) {
+        set_.emplace(re2::RE2::Options(), re2::RE2::UNANCHORED);
+      }
+      if (set_->Add(pattern, nullptr) < 0) {
+        throw std::invalid_argument("Invalid filter regex");
+      }
+    }
+
+    if (set_ && !set_->Compile()) {
+      throw std::invalid_argument("Invalid filter regex");
+    }
+  }
+
+  bool Matches(std::string_view data) const {
+    for (const auto& literal : literals_) {
+      if (literal.start && literal.end ? data == literal.text
+          : literal.start             ? data.starts_with(literal.text)
+          : literal.end               ? data.ends_with(literal.text)
+                                      : data.find(literal.text) != std::string_view::npos) {
+        return true;
+      }
+    }
+
+    return set_ && set_->Match(data, nullptr);
+  }
+
+  // The sorted prefixes if every pattern is a literal ^prefix, so a range that
+  // matches none of them can be skipped with a seek.
+  static std::optional<std::vector<std::string>> Prefixes(const std::vector<std::string>& patterns) {
+    std::vector<std::string> prefixes;
+    for (const auto& pattern : patterns) {
+      auto literal = ParseLiteral(pattern);
+      if (!literal || !literal->start || literal->end) {
+        return std::nullopt;
+      }
+      prefixes.push_back(std::move(literal->text));
+    }
+
+    if (prefixes.empty()) {
+      return std::nullopt;
+    }
+
+    std::sort(prefixes.begin(), prefixes.end());
+
+    return prefixes;
+  }
+
+  // The smallest key greater than every key starting with `prefix`.
+  static std::optional<std::string> Successor(std::string prefix) {
+    while (!prefix.empty()) {
+      if (static_cast<uint8_t>(prefix.back()) != 0xff) {
+        prefix.back()++;
+        return prefix;
+      }
+      prefix.pop_back();
+    }
+    return std::nullopt;
+  }
+
+ private:
+  static std::optional<Literal> ParseLiteral(std::string_view pattern) {
+    Literal literal{std::string(), pattern.starts_with('^'), false};
+    if (literal.start) {
+      pattern.remove_prefix(1);
+    }
+
+    literal.end = pattern.ends_with('$');
+    if (literal.end) {
+      pattern.remove_suffix(1);
+    }
+
+    if (pattern.find_first_of("\\.^$|?*+()[]{}") != std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    literal.text = pattern;
+    return literal;
+  }
+
+  std::vector<Literal> literals_;
+  std::optional<re2::RE2::Set> set_;
+};
+
+static napi_status GetValue(napi_env env, napi_value value, JsonPredicate::Operand& result) {
+  using Type = JsonPredicate::Operand::Type;
+
+  napi_valuetype type;
+  NAPI_STATUS_RETURN(napi_typeof(env, value, &type));
+
+  switch (type) {
+    case napi_string:
+      result.type = Type::String;
+      return GetString(env, value, result.string);
+    case napi_number:
+      result.type = Type::Number;
+      return napi_get_value_double(env, value, &result.number);
+    case napi_boolean:
+      result.type = Type::Bool;
+      return napi_get_value_bool(env, value, &result.boolean);
+    case napi_null:
+      result.type = Type::Null;
+      return napi_ok;
+    default:
+      return napi_invalid_arg;
+  }
+}
+
+// A `where` condition: { path, eq, ne, lt, lte, gt, gte, exists }, where path
+// is a dotted string or an array of segments. Several operators on one
+// condition must all hold, as must every condition of an array.
+static napi_status GetCondition(napi_env env, napi_value value, JsonPredicate& result) {
+  napi_value path;
+  NAPI_STATUS_RETURN(napi_get_named_property(env, value, "path", &path));
+
+  std::vector<std::string> segments;
+  napi_valuetype type;
+  NAPI_STATUS_RETURN(napi_typeof(env, path, &type));
+  if (type == napi_string) {
+    std::string dotted;
+    NAPI_STATUS_RETURN(GetString(env, path, dotted));
+    for (size_t start = 0, end; start <= dotted.size(); start = end + 1) {
+      end = std::min(dotted.find('.', start), dotted.size());
+      segments.push_back(dotted.substr(start, end - start));
+    }
+  } else {
+    NAPI_STATUS_RETURN(GetValue(env, path, segments));
+  }
+
+  static constexpr std::pair<const char*, JsonPredicate::Op> ops[] = {
+      {"eq", JsonPredicate::Op::Eq},   {"ne", JsonPredicate::Op::Ne}, {"lt", JsonPredicate::Op::Lt},
+      {"lte", JsonPredicate::Op::Lte}, {"gt", JsonPredicate::Op::Gt}, {"gte", JsonPredicate::Op::Gte},
+  };
+
+  bool any = false;
+  for (const auto& [name, op] : ops) {
+    napi_value operand;
+    NAPI_STATUS_RETURN(napi_get_named_property(env, value, name, &operand));
+    NAPI_STATUS_RETURN(napi_typeof(env, operand, &type));
+    if (type == napi_undefined) {
+      continue;
+    }
+
+    JsonPredicate::Test test{op, {}};
+    NAPI_STATUS_RETURN(GetValue(env, operand, test.operand));
+    result.Add(segments, std::move(test));
+    any = true;
+  }
+
+  std::optional<bool> exists;
+  NAPI_STATUS_RETURN(GetProperty(env, value, "exists", exists));
+  if (exists) {
+    JsonPredicate::Test test{JsonPredicate::Op::Exists, {}};
+    test.operand.boolean = *exists;
+    result.Add(segments, std::move(test));
+    any = true;
+  }
+
+  return any ? napi_ok : napi_invalid_arg;
+}
+
+// One condition or an array of them.
+static napi_status GetValue(napi_env env, napi_value value, JsonPredicate& result) {
+  bool isArray = false;
+  NAPI_STATUS_RETURN(napi_is_array(env, value, &isArray));
+
+  if (!isArray) {
+    return GetCondition(env, value, result);
+  }
+
+  uint32_t length;
+  NAPI_STATUS_RETURN(napi_get_array_length(env, value, &length));
+
+  for (uint32_t n = 0; n < length; n++) {
+    napi_value element;
+    NAPI_STATUS_RETURN(napi_get_element(env, value, n, &element));
+    NAPI_STATUS_RETURN(GetCondition(env, element, result));
+  }
+
+  return napi_ok;
+}
+
+// valueSlice: { offset, length } projects each value onto a byte range, and
+// { offset, lengthPrefix } onto the field at `offset` that starts with its own
+// little-endian length of 1, 2 or 4 bytes. Ranges are clamped to the value.
+struct ValueSlice {
+  size_t offset = 0;
+  size_t length = std::numeric_limits<size_t>::max();
+  uint32_t lengthPrefix = 0;
+
+  // The [start, end) of the projection within `value`.
+  std::pair<size_t, size_t> Range(const rocksdb::Slice& value) const {
+    size_t start = std::min(offset, value.size());
+    size_t count = length;
+
+    if (lengthPrefix) {
+      if (value.size() - start < lengthPrefix) {
+        return {value.size(), value.size()};
+      }
+      count = 0;
+      for (uint32_t n = 0; n < lengthPrefix; n++) {
+        count |= static_cast<size_t>(static_cast<uint8_t>(value[start + n])) << (8 * n);
+      }
+      start += lengthPrefix;
+    }
+
+    return {start, start + std::min(count, value.size() - start)};
+  }
+
+  rocksdb::Slice Apply(const rocksdb::Slice& value) const {
+    const auto [start, end] = Range(value);
+    return rocksdb::Slice(value.data() + start, end - start);
+  }
+
+  // Narrows in place. PinnableSlice cannot drop a prefix (remove_prefix is
+  // not implemented), so a projection past the start is copied into itself.
+  void Apply(rocksdb::PinnableSlice& value) const {
+    const auto [start, end] = Range(value);
+    value.remove_suffix(value.size() - end);
+    if (start > 0) {
+      std::string projected(value.data() + start, end - start);
+      value.Reset();
+      *value.GetSelf() = std::move(projected);
+      value.PinSelf();
+    }
+  }
+};
+
+static napi_status GetValue(napi_env env, napi_value value, ValueSlice& result) {
+  NAPI_STATUS_RETURN(GetProperty(env, value, "offset", result.offset));
+  NAPI_STATUS_RETURN(GetProperty(env, value, "length", result.length));
+  NAPI_STATUS_RETURN(GetProperty(env, value, "lengthPrefix", result.lengthPrefix));
+
+  if (result.lengthPrefix != 0 && result.lengthPrefix != 1 && result.lengthPrefix != 2 && result.lengthPrefix != 4) {
+    return napi_invalid_arg;
+  }
+
+  return napi_ok;
+}
+
 struct BaseIterator : public Closable {
   BaseIterator(Database* database,
                rocksdb::ColumnFamilyHandle* column,
@@ -332,8 +923,14 @@ struct BaseIterator : public Closable {
                const std::optional<std::string>& gt,
                const std::optional<std::string>& gte,
                const int limit,
-               rocksdb::ReadOptions readOptions = {})
-      : database_(database), column_(column), reverse_(reverse), limit_(limit) {
+               rocksdb::ReadOptions readOptions = {},
+               std::shared_ptr<const rocksdb::Snapshot> snapshot = nullptr,
+               std::shared_ptr<rocksdb::WriteBatchWithIndex> batch = nullptr)
+      : database_(database),
+        column_(column),
+        pinned_(readOptions.pin_data && !batch),
+        reverse_(reverse),
+        limit_(limit) {
     if (lte) {
       upper_bound_ = rocksdb::PinnableSlice();
       *upper_bound_->GetSelf() = std::move(*lte) + '\0';
@@ -354,15 +951,52 @@ struct BaseIterator : public Closable {
       lower_bound_->PinSelf();
     }
 
-    if (upper_bound_) {
-      readOptions.iterate_upper_bound = &*upper_bound_;
-    }
+    if (batch) {
+      if (upper_bound_) {
+        readOptions.iterate_upper_bound = &*upper_bound_;
+      }
 
-    if (lower_bound_) {
-      readOptions.iterate_lower_bound = &*lower_bound_;
-    }
+      if (lower_bound_) {
+        readOptions.iterate_lower_bound = &*lower_bound_;
+      }
+
+      // Merges the pending writes of the batch over the DB. The deleter holds
+      // the batch, which must not be cleared while this is open.
+      iterator_ = std::shared_ptr<rocksdb::Iterator>(
+          batch->NewIteratorWithBase(column_, database_->db->NewIterator(readOptions, column_), &readOptions),
+          [db = database_->db, snapshot = std::move(snapshot), batch](rocksdb::Iterator* iterator) {
+            delete iterator;
+          });
+    } else if (IteratorPool::Poolable(readOptions)) {
+      // Returned to the pool on close rather than destroyed.
+      auto entry = database_->iterators.Acquire(database_->db.get(), column_, lower_bound_ ? &*lower_bound_ : nullptr,
+                                                upper_bound_ ? &*upper_bound_ : nullptr);
+      iterator_ = std::shared_ptr<rocksdb::Iterator>(
+          entry.iterator.release(),
+          [database = database_, column = column_, bounds = std::move(entry.bounds), lower = entry.lower,
+           upper = entry.upper](rocksdb::Iterator* iterator) {
+            IteratorPool::Entry entry;
+            entry.iterator.reset(iterator);
+            entry.bounds = bounds;
+            entry.lower = lower;
+            entry.upper = upper;
+            database->iterators.Release(column, std::move(entry));
+          });
+    } else {
+      if (upper_bound_) {
+        readOptions.iterate_upper_bound = &*upper_bound_;
+      }
 
-    iterator_.reset(database_->db->NewIterator(readOptions, column_));
+      if (lower_bound_) {
+        readOptions.iterate_lower_bound = &*lower_bound_;
+      }
+
+      // The deleter holds the DB (and the snapshot read from) so an iterator
+      // kept alive by pinned buffers is never destroyed after them.
+      iterator_ = std::shared_ptr<rocksdb::Iterator>(
+          database_->db->NewIterator(readOptions, column_),
+          [db = database_->db, snapshot = std::move(snapshot)](rocksdb::Iterator* iterator) { delete iterator; });
+    }
 
     if (reverse_) {
       iterator_->SeekToLast();
@@ -396,6 +1030,16 @@ struct BaseIterator : public Closable {
     }
   }
 
+  // Positions the iterator past the last entry.
+  void SeekToEnd() {
+    assert(iterator_);
+
+    iterator_->SeekToLast();
+    if (iterator_->Valid()) {
+      iterator_->Next();
+    }
+  }
+
   virtual rocksdb::Status Close() override {
     if (iterator_) {
       lower_bound_.reset();
@@ -442,6 +1086,10 @@ struct BaseIterator : public Closable {
 
   virtual rocksdb::Status Refresh() {
     assert(iterator_);
+    if (iterator_.use_count() > 1) {
+      // Refresh releases the blocks that pinned buffers point into.
+      return rocksdb::Status::NotSupported("Cannot refresh while pinned buffers are alive");
+    }
     // Refresh restarts iteration, so the user `limit` budget must restart too;
     // otherwise an iterator that already yielded `limit` rows returns nothing
     // after a refresh even though every other piece of state was reset.
@@ -449,14 +1097,47 @@ struct BaseIterator : public Closable {
     return iterator_->Refresh();
   }
 
+  // Points `result` at the current key (or value) without copying it if the
+  // iterator pinned it (ReadOptions::pin_data). `result` then shares ownership
+  // of the iterator, keeping the underlying blocks loaded until it, or the
+  // external buffer it is moved into, is released.
+  void Pin(const bool value, rocksdb::PinnableSlice& result) const {
+    assert(iterator_);
+    Pin(value, value ? iterator_->value() : iterator_->key(), result);
+  }
+
+  // As above, for a `slice` within the current key (or value).
+  void Pin(const bool value, const rocksdb::Slice& slice, rocksdb::PinnableSlice& result) const {
+    assert(iterator_);
+
+    if (pinned_ && (value ? iterator_->IsValuePinned() : iterator_->IsKeyPinned())) {
+      ++*database_->pins;
+      result.PinSlice(slice, ReleasePin, new PinHolder{iterator_, database_->pins}, nullptr);
+    } else {
+      result.PinSelf(slice);
+    }
+  }
+
   Database* database_;
   rocksdb::ColumnFamilyHandle* column_;
+  const bool pinned_;
 
  private:
-  int count_ = 0;
+  struct PinHolder {
+    std::shared_ptr<rocksdb::Iterator> iterator;
+    std::shared_ptr<std::atomic<size_t>> pins;
+  };
+
+  static void ReleasePin(void* arg1, void* arg2) {
+    auto holder = reinterpret_cast<PinHolder*>(arg1);
+    --*holder->pins;
+    delete holder;
+  }
+
+  int count_ = 0;
   std::optional<rocksdb::PinnableSlice> lower_bound_;
   std::optional<rocksdb::PinnableSlice> upper_bound_;
-  std::unique_ptr<rocksdb::Iterator> iterator_;
+  std::shared_ptr<rocksdb::Iterator> iterator_;
   const bool reverse_;
   const int limit_;
 };
@@ -468,9 +1149,13 @@ class Iterator final : public BaseIterator {
   bool first_ = true;
   const Encoding keyEncoding_;
   const Encoding valueEncoding_;
-  std::optional<re2::RE2> keyFilter_;
-  std::optional<re2::RE2> valueFilter_;
+  std::optional<Filter> keyFilter_;
+  std::optional<Filter> valueFilter_;
+  std::optional<JsonPredicate> where_;
+  const std::optional<ValueSlice> valueSlice_;
+  std::optional<std::vector<std::string>> keyPrefixes_;
   const bool unsafe_;
+  const bool packed_;
 
  public:
   Iterator(Database* database,
@@ -484,31 +1169,48 @@ class Iterator final : public BaseIterator {
            const std::optional<std::string>& gt,
            const std::optional<std::string>& gte,
            const size_t highWaterMarkBytes,
-           std::optional<std::string> keyFilter = std::nullopt,
-           std::optional<std::string> valueFilter = std::nullopt,
+           std::optional<std::vector<std::string>> keyFilter = std::nullopt,
+           std::optional<std::vector<std::string>> valueFilter = std::nullopt,
+           std::optional<JsonPredicate> where = std::nullopt,
+           std::optional<ValueSlice> valueSlice = std::nullopt,
            Encoding keyEncoding = Encoding::Invalid,
            Encoding valueEncoding = Encoding::Invalid,
            const bool unsafe = false,
-           rocksdb::ReadOptions readOptions = {})
-      : BaseIterator(database, column, reverse, lt, lte, gt, gte, limit, readOptions),
+           const bool packed = false,
+           rocksdb::ReadOptions readOptions = {},
+           std::shared_ptr<const rocksdb::Snapshot> snapshot = nullptr,
+           std::shared_ptr<rocksdb::WriteBatchWithIndex> batch = nullptr)
+      : BaseIterator(database,
+                     column,
+                     reverse,
+                     lt,
+                     lte,
+                     gt,
+                     gte,
+                     limit,
+                     readOptions,
+                     std::move(snapshot),
+                     std::move(batch)),
         keys_(keys),
         values_(values),
         highWaterMarkBytes_(highWaterMarkBytes),
         keyEncoding_(keyEncoding),
         valueEncoding_(valueEncoding),
-        unsafe_(unsafe) {
+        where_(std::move(where)),
+        valueSlice_(valueSlice),
+        unsafe_(unsafe),
+        packed_(packed) {
     if (keyFilter) {
       keyFilter_.emplace(*keyFilter);
-      if (!keyFilter_->ok()) {
-        throw std::invalid_argument("Invalid key filter regex");
+
+      // Seeking past keys that match no prefix assumes bytewise key order.
+      if (!reverse && column->GetComparator() == rocksdb::BytewiseComparator()) {
+        keyPrefixes_ = Filter::Prefixes(*keyFilter);
       }
     }
 
     if (valueFilter) {
       valueFilter_.emplace(*valueFilter);
-      if (!valueFilter_->ok()) {
-        throw std::invalid_argument("Invalid value filter regex");
-      }
     }
   }
 
@@ -529,6 +1231,9 @@ class Iterator final : public BaseIterator {
     bool unsafe = false;
     NAPI_STATUS_THROWS(GetProperty(env, options, "unsafe", unsafe));
 
+    Format format = Format::Rows;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "format", format));
+
     bool reverse = false;
     NAPI_STATUS_THROWS(GetProperty(env, options, "reverse", reverse));
 
@@ -558,15 +1263,59 @@ class Iterator final : public BaseIterator {
     std::optional<std::string> gte;
     NAPI_STATUS_THROWS(GetProperty(env, options, "gte", gte));
 
-    std::optional<std::string> keyFilter;
+    std::optional<std::vector<std::string>> keyFilter;
     NAPI_STATUS_THROWS(GetProperty(env, options, "keyFilter", keyFilter));
 
-    std::optional<std::string> valueFilter;
+    std::optional<std::vector<std::string>> valueFilter;
     NAPI_STATUS_THROWS(GetProperty(env, options, "valueFilter", valueFilter));
 
+    std::optional<JsonPredicate> where;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "where", where));
+
+    std::optional<ValueSlice> valueSlice;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "valueSlice", valueSlice));
+
+    std::optional<std::string> prefix;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "prefix", prefix));
+
     rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
     NAPI_STATUS_THROWS(GetProperty(env, options, "column", column));
 
+    // A key filter of only ^prefix literals also bounds the range.
+    if (keyFilter && column->GetComparator() == rocksdb::BytewiseComparator()) {
+      if (const auto prefixes = Filter::Prefixes(*keyFilter)) {
+        const auto& lower = prefixes->front();
+        if (!(gte && *gte >= lower) && !(gt && *gt >= lower)) {
+          gte = lower;
+          gt.reset();
+        }
+
+        const auto upper = Filter::Successor(prefixes->back());
+        if (upper && !(lt && *lt <= *upper) && !(lte && *lte < *upper)) {
+          lt = upper;
+          lte.reset();
+        }
+      }
+    }
+
+    // As does a prefix, which also lets prefix blooms skip files (see below).
+    if (prefix) {
+      if (column->GetComparator() != rocksdb::BytewiseComparator()) {
+        throw std::invalid_argument("prefix requires the bytewise comparator");
+      }
+
+      if (!(gte && *gte >= *prefix) && !(gt && *gt >= *prefix)) {
+        gte = *prefix;
+        gt.reset();
+      }
+
+      const auto upper = Filter::Successor(*prefix);
+      if (upper && !(lt && *lt <= *upper) && !(lte && *lte < *upper)) {
+        lt = upper;
+        lte.reset();
+      }
+    }
+
     Encoding keyEncoding = Encoding::Buffer;
     NAPI_STATUS_THROWS(GetProperty(env, options, "keyEncoding", keyEncoding));
 
@@ -575,6 +1324,12 @@ class Iterator final : public BaseIterator {
 
     rocksdb::ReadOptions readOptions;
 
+    // Lets unsafe buffers reference block memory directly instead of a copy.
+    // The iterator cannot be refreshed, nor the db closed, until they are
+    // garbage collected.
+    readOptions.pin_data = false;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "pinData", readOptions.pin_data));
+
     readOptions.background_purge_on_iterator_cleanup = true;
     NAPI_STATUS_THROWS(GetProperty(env, options, "backgroundPurgeOnIteratorCleanup",
                                    readOptions.background_purge_on_iterator_cleanup));
@@ -600,6 +1355,29 @@ class Iterator final : public BaseIterator {
     readOptions.ignore_range_deletions = false;
     NAPI_STATUS_THROWS(GetProperty(env, options, "ignoreRangeDeletions", readOptions.ignore_range_deletions));
 
+    if (prefix) {
+      // prefix_same_as_start stops at the first key whose extracted prefix
+      // differs from that of the seek target, which matches the bounds only if
+      // the extractor never looks past `prefix`. SeekToLast seeks to the upper
+      // bound (outside the prefix), so reverse iterators rely on
+      // auto_prefix_mode instead, which checks the bounds itself.
+      const auto extractor = database->PrefixExtractor(column);
+      const auto probe = *prefix + '\0';
+      if (extractor && !reverse && extractor->InDomain(probe) && extractor->Transform(probe).size() <= prefix->size()) {
+        readOptions.prefix_same_as_start = true;
+        readOptions.total_order_seek = false;
+      } else {
+        readOptions.auto_prefix_mode = true;
+      }
+    }
+
+    std::shared_ptr<const rocksdb::Snapshot> snapshot;
+    NAPI_STATUS_THROWS(GetSnapshot(env, options, readOptions, snapshot));
+
+    // Reads through an indexed batch (see ChainedBatch#iterator).
+    Batch* batch = nullptr;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "batch", batch));
+
     // uint32_t timeout = 0;
     // NAPI_STATUS_THROWS(GetProperty(env, options, "timeout", timeout));
 
@@ -608,14 +1386,22 @@ class Iterator final : public BaseIterator {
     //   : std::chrono::microseconds::zero();
 
     return std::make_unique<Iterator>(database, column, reverse, keys, values, limit, lt, lte, gt, gte,
-                                      highWaterMarkBytes, keyFilter, valueFilter, keyEncoding, valueEncoding, unsafe,
-                                      readOptions);
+                                      highWaterMarkBytes, keyFilter, valueFilter, std::move(where), valueSlice,
+                                      keyEncoding, valueEncoding, unsafe, format == Format::Packed, readOptions,
+                                      std::move(snapshot), batch ? batch->indexed : nullptr);
   }
 
-  napi_value nextv(napi_env env, uint32_t count, uint32_t timeout, napi_value callback) {
+  // With a `target`, seeks to it first as part of the same async work.
+  napi_value nextv(napi_env env,
+                   uint32_t count,
+                   uint32_t timeout,
+                   napi_value callback,
+                   std::optional<std::string> target = std::nullopt) {
     struct State {
       std::vector<rocksdb::PinnableSlice> keys;
       std::vector<rocksdb::PinnableSlice> values;
+      std::string data;
+      std::vector<uint32_t> offsets;
       size_t count = 0;
       size_t bytes = 0;
       bool finished = false;
@@ -627,9 +1413,18 @@ class Iterator final : public BaseIterator {
 
     NAPI_STATUS_THROWS(runAsync<State>(
         resourceName, env, callback,
-        [=](auto& state) {
-          state.keys.reserve(count);
-          state.values.reserve(count);
+        [=, target = std::move(target)](auto& state) {
+          if (target) {
+            Seek(*target);
+          }
+
+          if (packed_) {
+            state.offsets.reserve(std::min<size_t>(count, 1024) * 2 + 1);
+            state.offsets.push_back(0);
+          } else {
+            state.keys.reserve(count);
+            state.values.reserve(count);
+          }
 
           const auto deadline = timeout ? database_->db->GetEnv()->NowMicros() + timeout * 1000 : 0;
 
@@ -665,12 +1460,15 @@ class Iterator final : public BaseIterator {
             // then discarded. Otherwise a `{ limit, keyFilter }` query could
             // exhaust its budget on non-matching rows and return fewer (or zero)
             // matches than exist.
-            if (keyFilter_ && !re2::RE2::PartialMatch(CurrentKey().ToStringView(), *keyFilter_)) {
+            if (!Matches()) {
               continue;
             }
 
-            if (valueFilter_ && !re2::RE2::PartialMatch(CurrentValue().ToStringView(), *valueFilter_)) {
-              continue;
+            if (packed_ && state.count > 0 && !FitsPacked(state.data)) {
+              // Leave the row for the next batch; offsets are 32-bit.
+              first_ = true;
+              state.limited = true;
+              break;
             }
 
             if (!Increment()) {
@@ -681,24 +1479,27 @@ class Iterator final : public BaseIterator {
               break;
             }
 
-            if (keys_ && values_) {
+            if (packed_) {
+              AppendPacked(state.data, state.offsets);
+              state.bytes = state.data.size();
+            } else if (keys_ && values_) {
               rocksdb::PinnableSlice k;
-              k.PinSelf(CurrentKey());
+              Pin(false, k);
               state.bytes += k.size();
               state.keys.push_back(std::move(k));
 
               rocksdb::PinnableSlice v;
-              v.PinSelf(CurrentValue());
+              Pin(true, Value(), v);
               state.bytes += v.size();
               state.values.push_back(std::move(v));
             } else if (keys_) {
               rocksdb::PinnableSlice k;
-              k.PinSelf(CurrentKey());
+              Pin(false, k);
               state.bytes += k.size();
               state.keys.push_back(std::move(k));
             } else if (values_) {
               rocksdb::PinnableSlice v;
-              v.PinSelf(CurrentValue());
+              Pin(true, Value(), v);
               state.bytes += v.size();
               state.values.push_back(std::move(v));
             } else {
@@ -716,6 +1517,15 @@ class Iterator final : public BaseIterator {
           napi_value limited;
           NAPI_STATUS_RETURN(napi_get_boolean(env, state.limited, &limited));
 
+          NAPI_STATUS_RETURN(napi_create_object(env, result));
+
+          if (packed_) {
+            NAPI_STATUS_RETURN(ConvertPacked(env, std::move(state.data), std::move(state.offsets), *result));
+            NAPI_STATUS_RETURN(napi_set_named_property(env, *result, "finished", finished));
+            NAPI_STATUS_RETURN(napi_set_named_property(env, *result, "limited", limited));
+            return napi_ok;
+          }
+
           napi_value rows;
           NAPI_STATUS_RETURN(napi_create_array(env, &rows));
 
@@ -740,7 +1550,6 @@ class Iterator final : public BaseIterator {
             NAPI_STATUS_RETURN(napi_set_element(env, rows, n * 2 + 1, val));
           }
 
-          NAPI_STATUS_RETURN(napi_create_object(env, result));
           NAPI_STATUS_RETURN(napi_set_named_property(env, *result, "rows", rows));
           NAPI_STATUS_RETURN(napi_set_named_property(env, *result, "finished", finished));
           NAPI_STATUS_RETURN(napi_set_named_property(env, *result, "limited", limited));
@@ -758,8 +1567,16 @@ class Iterator final : public BaseIterator {
     napi_value limited;
     NAPI_STATUS_THROWS(napi_get_boolean(env, false, &limited));
 
-    napi_value rows;
-    NAPI_STATUS_THROWS(napi_create_array(env, &rows));
+    napi_value rows = nullptr;
+    if (!packed_) {
+      NAPI_STATUS_THROWS(napi_create_array(env, &rows));
+    }
+
+    std::string data;
+    std::vector<uint32_t> offsets;
+    if (packed_) {
+      offsets.push_back(0);
+    }
 
     const auto deadline = timeout ? database_->db->GetEnv()->NowMicros() + timeout * 1000 : 0;
 
@@ -795,12 +1612,15 @@ class Iterator final : public BaseIterator {
 
       // Apply the key/value filters BEFORE charging the user `limit`, so `limit`
       // counts matched (emitted) rows, not rows merely scanned and discarded.
-      if (keyFilter_ && !re2::RE2::PartialMatch(CurrentKey().ToStringView(), *keyFilter_)) {
+      if (!Matches()) {
         continue;
       }
 
-      if (valueFilter_ && !re2::RE2::PartialMatch(CurrentValue().ToStringView(), *valueFilter_)) {
-        continue;
+      if (packed_ && idx > 0 && !FitsPacked(data)) {
+        // Leave the row for the next batch; offsets are 32-bit.
+        first_ = true;
+        NAPI_STATUS_THROWS(napi_get_boolean(env, true, &limited));
+        break;
       }
 
       if (!Increment()) {
@@ -811,21 +1631,28 @@ class Iterator final : public BaseIterator {
         break;
       }
 
+      if (packed_) {
+        AppendPacked(data, offsets);
+        bytes = data.size();
+        idx += 2;
+        continue;
+      }
+
       napi_value key;
       napi_value val;
 
       if (keys_ && values_) {
-        bytes += CurrentKey().size() + CurrentValue().size();
-        NAPI_STATUS_THROWS(Convert(env, CurrentKey(), keyEncoding_, key, unsafe_));
-        NAPI_STATUS_THROWS(Convert(env, CurrentValue(), valueEncoding_, val, unsafe_));
+        bytes += CurrentKey().size() + Value().size();
+        NAPI_STATUS_THROWS(ConvertCurrent(env, false, keyEncoding_, key));
+        NAPI_STATUS_THROWS(ConvertCurrent(env, true, valueEncoding_, val));
       } else if (keys_) {
         bytes += CurrentKey().size();
-        NAPI_STATUS_THROWS(Convert(env, CurrentKey(), keyEncoding_, key, unsafe_));
+        NAPI_STATUS_THROWS(ConvertCurrent(env, false, keyEncoding_, key));
         NAPI_STATUS_THROWS(napi_get_undefined(env, &val));
       } else if (values_) {
-        bytes += CurrentValue().size();
+        bytes += Value().size();
         NAPI_STATUS_THROWS(napi_get_undefined(env, &key));
-        NAPI_STATUS_THROWS(Convert(env, CurrentValue(), valueEncoding_, val, unsafe_));
+        NAPI_STATUS_THROWS(ConvertCurrent(env, true, valueEncoding_, val));
       } else {
         assert(false);
       }
@@ -836,11 +1663,132 @@ class Iterator final : public BaseIterator {
 
     napi_value ret;
     NAPI_STATUS_THROWS(napi_create_object(env, &ret));
-    NAPI_STATUS_THROWS(napi_set_named_property(env, ret, "rows", rows));
+    if (packed_) {
+      NAPI_STATUS_THROWS(ConvertPacked(env, std::move(data), std::move(offsets), ret));
+    } else {
+      NAPI_STATUS_THROWS(napi_set_named_property(env, ret, "rows", rows));
+    }
     NAPI_STATUS_THROWS(napi_set_named_property(env, ret, "finished", finished));
     NAPI_STATUS_THROWS(napi_set_named_property(env, ret, "limited", limited));
     return ret;
   }
+
+  // Walks the rest of the range like nextv, with the same filters and limit,
+  // but only tallies the matching rows. Keys and values that were not
+  // requested (keys: false / values: false) are not summed.
+  rocksdb::Status Count(uint64_t& count, uint64_t& keyBytes, uint64_t& valueBytes) {
+    while (true) {
+      if (!first_) {
+        Next();
+      } else {
+        first_ = false;
+      }
+
+      ROCKS_STATUS_RETURN(Status());
+
+      if (!Valid()) {
+        return rocksdb::Status::OK();
+      }
+
+      if (!Matches()) {
+        continue;
+      }
+
+      if (!Increment()) {
+        return rocksdb::Status::OK();
+      }
+
+      count += 1;
+      if (keys_) {
+        keyBytes += CurrentKey().size();
+      }
+      if (values_) {
+        valueBytes += Value().size();
+      }
+    }
+  }
+
+ private:
+  // When the key filter is only ^prefix literals, a non-matching key also
+  // seeks ahead to the next prefix (or the end), so callers must not step past
+  // the new position (Seek sets first_).
+  bool Matches() {
+    if (keyFilter_ && !keyFilter_->Matches(CurrentKey().ToStringView())) {
+      if (keyPrefixes_) {
+        const auto key = CurrentKey().ToStringView();
+        const auto next = std::upper_bound(keyPrefixes_->begin(), keyPrefixes_->end(), key,
+                                           [](std::string_view a, const std::string& b) { return a < b; });
+        if (next != keyPrefixes_->end()) {
+          Seek(*next);
+        } else {
+          SeekToEnd();
+          first_ = true;
+        }
+      }
+      return false;
+    }
+
+    if (valueFilter_ && !valueFilter_->Matches(CurrentValue().ToStringView())) {
+      return false;
+    }
+
+    if (where_ && !where_->Matches(CurrentValue().ToStringView())) {
+      return false;
+    }
+
+    return true;
+  }
+
+  // The current value, projected by `valueSlice`.
+  rocksdb::Slice Value() const { return valueSlice_ ? valueSlice_->Apply(CurrentValue()) : CurrentValue(); }
+
+  napi_status ConvertCurrent(napi_env env, const bool value, const Encoding encoding, napi_value& result) const {
+    const auto slice = value ? Value() : CurrentKey();
+    if (pinned_) {
+      rocksdb::PinnableSlice pinned;
+      Pin(value, slice, pinned);
+      return Convert(env, std::move(pinned), encoding, result, unsafe_);
+    }
+    return Convert(env, slice, encoding, result, unsafe_);
+  }
+
+  // format: 'packed' writes every key and value of a batch into one slab, and
+  // `offsets` holds count * 2 + 1 boundaries: row n's key is
+  // [offsets[2n], offsets[2n + 1]) and its value [offsets[2n + 1], offsets[2n + 2]).
+  // A side that was not requested (keys: false / values: false) is empty.
+  bool FitsPacked(const std::string& data) const {
+    const size_t size = (keys_ ? CurrentKey().size() : 0) + (values_ ? Value().size() : 0);
+    return data.size() + size <= std::numeric_limits<uint32_t>::max();
+  }
+
+  void AppendPacked(std::string& data, std::vector<uint32_t>& offsets) const {
+    if (keys_) {
+      const auto key = CurrentKey();
+      data.append(key.data(), key.size());
+    }
+    offsets.push_back(static_cast<uint32_t>(data.size()));
+
+    if (values_) {
+      const auto value = Value();
+      data.append(value.data(), value.size());
+    }
+    offsets.push_back(static_cast<uint32_t>(data.size()));
+  }
+
+  static napi_status ConvertPacked(napi_env env,
+                                   std::string&& data,
+                                   std::vector<uint32_t>&& offsets,
+                                   napi_value result) {
+    napi_value buffer;
+    NAPI_STATUS_RETURN(ConvertExternal(env, std::move(data), buffer));
+    NAPI_STATUS_RETURN(napi_set_named_property(env, result, "buffer", buffer));
+
+    napi_value offsets2;
+    NAPI_STATUS_RETURN(ConvertExternal(env, std::move(offsets), offsets2));
+    NAPI_STATUS_RETURN(napi_set_named_property(env, result, "offsets", offsets2));
+
+    return napi_ok;
+  }
 };
 
 /**
@@ -858,7 +1806,7 @@ static void env_cleanup_hook(void* data) {
   // where it's our responsibility to clean up. Note also, the following code must
   // be a safe noop if called before db_open() or after db_close().
   if (database) {
-    database->Close();
+    database->Abandon();
   }
 }
 
@@ -870,7 +1818,7 @@ static void FinalizeDatabase(napi_env env, void* data, void* hint) {
       napi_delete_reference(env, database->resourceNamesRef);
       database->resourceNamesRef = nullptr;
     }
-    database->Close();
+    database->Abandon();
     // This external owns the Database (the bigint-handle external in db_init is
     // created with no finalizer, so it never reaches here). Close() already
     // released the rocksdb::DB; free the heap object itself or it leaks for the
@@ -1043,6 +1991,12 @@ napi_status InitOptions(napi_env env, T& columnOptions, const U& options) {
     }
   }
 
+  // Flushed memtables kept for conflict checks of optimistic transactions. If
+  // unset, OptimisticTransactionDB keeps max_write_buffer_number *
+  // write_buffer_size; commits that reach past it fail with TryAgain.
+  NAPI_STATUS_RETURN(GetProperty(env, options, "maxWriteBufferSizeToMaintain",
+                                 columnOptions.max_write_buffer_size_to_maintain));
+
   std::string prefixExtractor;
   NAPI_STATUS_RETURN(GetProperty(env, options, "prefixExtractor", prefixExtractor));
   if (prefixExtractor == "") {
@@ -1050,6 +2004,9 @@ napi_status InitOptions(napi_env env, T& columnOptions, const U& options) {
   } else {
     ROCKS_STATUS_RETURN_NAPI(
         rocksdb::SliceTransform::CreateFromString(configOptions, prefixExtractor, &columnOptions.prefix_extractor));
+
+    // Lets prefix iterators skip memtables without the prefix too.
+    columnOptions.memtable_prefix_bloom_size_ratio = 0.02;
   }
 
   std::string comparator;
@@ -1241,11 +2198,31 @@ napi_status InitOptions(napi_env env, T& columnOptions, const U& options) {
     columnOptions.memtable_prefix_bloom_size_ratio = 0.02;
     columnOptions.memtable_whole_key_filtering = true;
   } else if (optimize == "range-lookup") {
-    // TODO?
+    // Scans read many consecutive blocks: make them larger, and partition the
+    // index and filters so that only the partitions in range are loaded (and
+    // cached alongside the data). With a prefix extractor, filters hold only
+    // prefixes, which is what prefix scans check.
+    tableOptions.index_type = rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+    tableOptions.partition_filters = true;
+    tableOptions.cache_index_and_filter_blocks = true;
+    tableOptions.pin_top_level_index_and_filter = true;
+    tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10));
+    tableOptions.whole_key_filtering = !columnOptions.prefix_extractor;
+    tableOptions.block_size = 16 * 1024;
+    tableOptions.block_restart_interval = 32;
+    tableOptions.index_shortening = rocksdb::BlockBasedTableOptions::IndexShorteningMode::kShortenSeparatorsAndSuccessor;
+
+    // Start reading ahead on the first sequential read, up to 1 MiB.
+    tableOptions.initial_auto_readahead_size = 64 * 1024;
+    tableOptions.max_auto_readahead_size = 1024 * 1024;
+    tableOptions.num_file_reads_for_auto_readahead = 0;
   } else {
     return napi_invalid_arg;
   }
 
+  NAPI_STATUS_RETURN(
+      GetProperty(env, options, "memtablePrefixBloomSizeRatio", columnOptions.memtable_prefix_bloom_size_ratio));
+
   std::string indexType;
   NAPI_STATUS_RETURN(GetProperty(env, options, "indexType", indexType));
   if (indexType == "") {
@@ -1300,6 +2277,9 @@ napi_status InitOptions(napi_env env, T& columnOptions, const U& options) {
       GetProperty(env, options, "dataBlockHashTableUtilRatio", tableOptions.data_block_hash_table_util_ratio));
   NAPI_STATUS_RETURN(GetProperty(env, options, "blockSize", tableOptions.block_size));
   NAPI_STATUS_RETURN(GetProperty(env, options, "blockRestartInterval", tableOptions.block_restart_interval));
+  NAPI_STATUS_RETURN(GetProperty(env, options, "metadataBlockSize", tableOptions.metadata_block_size));
+  NAPI_STATUS_RETURN(GetProperty(env, options, "partitionFilters", tableOptions.partition_filters));
+  NAPI_STATUS_RETURN(GetProperty(env, options, "wholeKeyFiltering", tableOptions.whole_key_filtering));
   NAPI_STATUS_RETURN(GetProperty(env, options, "blockAlign", tableOptions.block_align));
   NAPI_STATUS_RETURN(
       GetProperty(env, options, "cacheIndexAndFilterBlocks", tableOptions.cache_index_and_filter_blocks));
@@ -1312,125 +2292,423 @@ napi_status InitOptions(napi_env env, T& columnOptions, const U& options) {
   NAPI_STATUS_RETURN(
       GetProperty(env, options, "numFileReadsForAutoReadahead", tableOptions.num_file_reads_for_auto_readahead));
 
+  // Partitioned filters need a partitioned index, which an explicit indexType
+  // may have replaced.
+  if (tableOptions.index_type != rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch) {
+    tableOptions.partition_filters = false;
+  }
+
   columnOptions.table_factory.reset(rocksdb::NewBlockBasedTableFactory(tableOptions));
 
   return napi_ok;
 }
 
-NAPI_METHOD(db_get_identity) {
-  NAPI_ARGV(1);
+struct QueryRange {
+  std::optional<std::string> lt;
+  std::optional<std::string> lte;
+  std::optional<std::string> gt;
+  std::optional<std::string> gte;
+  int32_t limit = -1;
+  bool reverse = false;
+};
 
-  Database* database;
-  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+static napi_status GetValue(napi_env env, napi_value value, QueryRange& result) {
+  NAPI_STATUS_RETURN(GetProperty(env, value, "lt", result.lt));
+  NAPI_STATUS_RETURN(GetProperty(env, value, "lte", result.lte));
+  NAPI_STATUS_RETURN(GetProperty(env, value, "gt", result.gt));
+  NAPI_STATUS_RETURN(GetProperty(env, value, "gte", result.gte));
+  NAPI_STATUS_RETURN(GetProperty(env, value, "limit", result.limit));
+  NAPI_STATUS_RETURN(GetProperty(env, value, "reverse", result.reverse));
+  return napi_ok;
+}
 
-  if (!database->db) {
-    napi_throw_error(env, "LEVEL_DATABASE_NOT_OPEN", "Database is not open");
-    return NULL;
-  }
+// Reads several ranges with a single rocksdb::Iterator, seeking from one range
+// to the next, so bounds are checked against the column comparator rather than
+// set as iterate bounds. Rows are packed as in Iterator: row n's key is
+// [offsets[2n], offsets[2n + 1]) and its value [offsets[2n + 1], offsets[2n + 2]),
+// and range i holds rows [ranges[i], ranges[i + 1]).
+class QueryMany {
+ public:
+  QueryMany(Database* database,
+            rocksdb::ColumnFamilyHandle* column,
+            std::vector<QueryRange>&& queries,
+            const bool keys,
+            const bool values,
+            const Encoding keyEncoding,
+            const Encoding valueEncoding,
+            const bool packed,
+            rocksdb::ReadOptions readOptions,
+            std::shared_ptr<const rocksdb::Snapshot> snapshot)
+      : database_(database),
+        column_(column),
+        queries_(std::move(queries)),
+        keys_(keys),
+        values_(values),
+        keyEncoding_(keyEncoding),
+        valueEncoding_(valueEncoding),
+        packed_(packed),
+        pooled_(IteratorPool::Poolable(readOptions)),
+        readOptions_(readOptions),
+        snapshot_(std::move(snapshot)) {}
 
-  std::string identity;
-  ROCKS_STATUS_THROWS_NAPI(database->db->GetDbIdentity(identity));
+  static std::unique_ptr<QueryMany> create(napi_env env, napi_value db, napi_value queries, napi_value options) {
+    Database* database;
+    NAPI_STATUS_THROWS(napi_get_value_external(env, db, reinterpret_cast<void**>(&database)));
 
-  napi_value result;
-  NAPI_STATUS_THROWS(Convert(env, identity, Encoding::String, result));
+    uint32_t length;
+    NAPI_STATUS_THROWS(napi_get_array_length(env, queries, &length));
 
-  return result;
-}
+    std::vector<QueryRange> queries2(length);
+    for (uint32_t n = 0; n < length; n++) {
+      napi_value element;
+      NAPI_STATUS_THROWS(napi_get_element(env, queries, n, &element));
+      NAPI_STATUS_THROWS(GetValue(env, element, queries2[n]));
+    }
 
-NAPI_METHOD(db_open) {
-  NAPI_ARGV(3);
+    rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+    NAPI_STATUS_THROWS(GetProperty(env, options, "column", column));
 
-  Database* database;
-  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+    bool keys = true;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "keys", keys));
 
-  if (database->db) {
-    napi_value columns;
-    NAPI_STATUS_THROWS(napi_create_object(env, &columns));
-    for (auto& [id, column] : database->columns) {
-      napi_value val;
-      NAPI_STATUS_THROWS(napi_create_external(env, column.handle, nullptr, nullptr, &val));
-      NAPI_STATUS_THROWS(napi_set_named_property(env, columns, column.descriptor.name.c_str(), val));
-    }
-    return columns;
-  } else {
-    rocksdb::Options dbOptions;
+    bool values = true;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "values", values));
 
-    const auto options = argv[1];
+    Encoding keyEncoding = Encoding::Buffer;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "keyEncoding", keyEncoding));
 
-    int parallelism = std::max<int>(1, std::thread::hardware_concurrency() / 2);
-    NAPI_STATUS_THROWS(GetProperty(env, options, "parallelism", parallelism));
-    dbOptions.IncreaseParallelism(parallelism);
+    Encoding valueEncoding = Encoding::Buffer;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "valueEncoding", valueEncoding));
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "walDir", dbOptions.wal_dir));
+    Format format = Format::Rows;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "format", format));
 
-    // 64-bit inputs: walTTL is in ms and walSizeLimit in bytes, so a 32-bit type
-    // wraps a >= ~4.3 GB size limit (or a ~49-day TTL) before the unit conversion.
-    uint64_t walTTL = 0;
-    NAPI_STATUS_THROWS(GetProperty(env, options, "walTTL", walTTL));
-    dbOptions.WAL_ttl_seconds = static_cast<uint64_t>(std::ceil(walTTL / 1e3));
+    auto readOptions = IteratorPool::Defaults();
+    NAPI_STATUS_THROWS(GetProperty(env, options, "fillCache", readOptions.fill_cache));
+    NAPI_STATUS_THROWS(GetProperty(env, options, "asyncIO", readOptions.async_io));
 
-    uint64_t walSizeLimit = 0;
-    NAPI_STATUS_THROWS(GetProperty(env, options, "walSizeLimit", walSizeLimit));
-    dbOptions.WAL_size_limit_MB = static_cast<uint64_t>(std::ceil(walSizeLimit / 1e6));
+    // One unbounded iterator serves every range, which may span prefixes, so
+    // it must not seek in prefix mode. Such iterators are not pooled.
+    readOptions.total_order_seek = database->PrefixExtractor(column) != nullptr;
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "maxTotalWalSize", dbOptions.max_total_wal_size));
+    std::shared_ptr<const rocksdb::Snapshot> snapshot;
+    NAPI_STATUS_THROWS(GetSnapshot(env, options, readOptions, snapshot));
 
-    bool walCompression = true;
-    NAPI_STATUS_THROWS(GetProperty(env, options, "walCompression", walCompression));
-    dbOptions.wal_compression =
-        walCompression ? rocksdb::CompressionType::kZSTD : rocksdb::CompressionType::kNoCompression;
+    return std::make_unique<QueryMany>(database, column, std::move(queries2), keys, values, keyEncoding,
+                                       valueEncoding, format == Format::Packed, readOptions, std::move(snapshot));
+  }
 
-    dbOptions.avoid_unnecessary_blocking_io = true;
-    NAPI_STATUS_THROWS(
-        GetProperty(env, options, "avoidUnnecessaryBlockingIO", dbOptions.avoid_unnecessary_blocking_io));
+  rocksdb::Status Execute() {
+    IteratorPool::Entry entry;
+    if (pooled_) {
+      entry = database_->iterators.Acquire(database_->db.get(), column_);
+    } else {
+      entry.iterator.reset(database_->db->NewIterator(readOptions_, column_));
+    }
+    auto& iterator = entry.iterator;
+    const auto comparator = column_->GetComparator();
+
+    offsets_.push_back(0);
+    ranges_.push_back(0);
+
+    for (const auto& query : queries_) {
+      if (query.reverse) {
+        if (query.lte) {
+          iterator->SeekForPrev(*query.lte);
+        } else if (query.lt) {
+          iterator->SeekForPrev(*query.lt);
+          if (iterator->Valid() && comparator->Compare(iterator->key(), *query.lt) == 0) {
+            iterator->Prev();
+          }
+        } else {
+          iterator->SeekToLast();
+        }
+      } else {
+        if (query.gte) {
+          iterator->Seek(*query.gte);
+        } else if (query.gt) {
+          iterator->Seek(*query.gt);
+          if (iterator->Valid() && comparator->Compare(iterator->key(), *query.gt) == 0) {
+            iterator->Next();
+          }
+        } else {
+          iterator->SeekToFirst();
+        }
+      }
 
-    dbOptions.create_missing_column_families = true;
-    NAPI_STATUS_THROWS(
-        GetProperty(env, options, "createMissingColumnFamilies", dbOptions.create_missing_column_families));
+      for (int32_t count = 0; iterator->Valid() && (query.limit < 0 || count < query.limit); count++) {
+        const auto key = iterator->key();
+        if ((query.lt && comparator->Compare(key, *query.lt) >= 0) ||
+            (query.lte && comparator->Compare(key, *query.lte) > 0) ||
+            (query.gt && comparator->Compare(key, *query.gt) <= 0) ||
+            (query.gte && comparator->Compare(key, *query.gte) < 0)) {
+          break;
+        }
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "writeDbIdToManifest", dbOptions.write_dbid_to_manifest));
+        if (keys_) {
+          data_.append(key.data(), key.size());
+        }
+        offsets_.push_back(static_cast<uint32_t>(data_.size()));
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "adviseRandomOnOpen", dbOptions.advise_random_on_open));
+        if (values_) {
+          const auto value = iterator->value();
+          data_.append(value.data(), value.size());
+        }
+        offsets_.push_back(static_cast<uint32_t>(data_.size()));
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "bytesPerSync", dbOptions.bytes_per_sync));
+        if (data_.size() > std::numeric_limits<uint32_t>::max()) {
+          return rocksdb::Status::Aborted("Query result exceeds 4 GiB");
+        }
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "walBytesPerSync", dbOptions.wal_bytes_per_sync));
+        if (query.reverse) {
+          iterator->Prev();
+        } else {
+          iterator->Next();
+        }
+      }
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "strictBytesPerSync", dbOptions.strict_bytes_per_sync));
+      ROCKS_STATUS_RETURN(iterator->status());
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "delayedWriteRate", dbOptions.delayed_write_rate));
+      ranges_.push_back(static_cast<uint32_t>(offsets_.size() / 2));
+    }
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "createIfMissing", dbOptions.create_if_missing));
+    if (pooled_) {
+      database_->iterators.Release(column_, std::move(entry));
+    }
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "errorIfExists", dbOptions.error_if_exists));
+    return rocksdb::Status::OK();
+  }
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "pipelinedWrite", dbOptions.enable_pipelined_write));
+  // An array with the rows of each range, or { buffer, offsets, ranges } when
+  // packed.
+  napi_status ConvertResult(napi_env env, napi_value& result) {
+    if (packed_) {
+      NAPI_STATUS_RETURN(napi_create_object(env, &result));
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "dailyOffpeakTime", dbOptions.daily_offpeak_time_utc));
+      napi_value buffer;
+      NAPI_STATUS_RETURN(ConvertExternal(env, std::move(data_), buffer));
+      NAPI_STATUS_RETURN(napi_set_named_property(env, result, "buffer", buffer));
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "unorderedWrite", dbOptions.unordered_write));
+      napi_value offsets;
+      NAPI_STATUS_RETURN(ConvertExternal(env, std::move(offsets_), offsets));
+      NAPI_STATUS_RETURN(napi_set_named_property(env, result, "offsets", offsets));
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "allowMmapReads", dbOptions.allow_mmap_reads));
+      napi_value ranges;
+      NAPI_STATUS_RETURN(ConvertExternal(env, std::move(ranges_), ranges));
+      NAPI_STATUS_RETURN(napi_set_named_property(env, result, "ranges", ranges));
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "allowMmapWrites", dbOptions.allow_mmap_writes));
+      return napi_ok;
+    }
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "memTableHugePageSize", dbOptions.memtable_huge_page_size));
+    NAPI_STATUS_RETURN(napi_create_array_with_length(env, queries_.size(), &result));
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "useDirectIOReads", dbOptions.use_direct_reads));
+    for (size_t n = 0; n < queries_.size(); n++) {
+      napi_value rows;
+      NAPI_STATUS_RETURN(napi_create_array(env, &rows));
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "useDirectIOForFlushAndCompaction",
-                                   dbOptions.use_direct_io_for_flush_and_compaction));
+      for (size_t row = ranges_[n], idx = 0; row < ranges_[n + 1]; row++) {
+        napi_value key;
+        napi_value val;
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "compactionReadaheadSize", dbOptions.compaction_readahead_size));
+        if (keys_) {
+          NAPI_STATUS_RETURN(Convert(env, Element(row * 2), keyEncoding_, key));
+        } else {
+          NAPI_STATUS_RETURN(napi_get_undefined(env, &key));
+        }
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "useAdaptiveMutex", dbOptions.use_adaptive_mutex));
+        if (values_) {
+          NAPI_STATUS_RETURN(Convert(env, Element(row * 2 + 1), valueEncoding_, val));
+        } else {
+          NAPI_STATUS_RETURN(napi_get_undefined(env, &val));
+        }
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "writeBufferSize", dbOptions.db_write_buffer_size));
+        NAPI_STATUS_RETURN(napi_set_element(env, rows, idx++, key));
+        NAPI_STATUS_RETURN(napi_set_element(env, rows, idx++, val));
+      }
 
-    NAPI_STATUS_THROWS(GetProperty(env, options, "manualWALFlush", dbOptions.manual_wal_flush));
-    NAPI_STATUS_THROWS(GetProperty(env, options, "walManualFlush", dbOptions.manual_wal_flush));
+      NAPI_STATUS_RETURN(napi_set_element(env, result, n, rows));
+    }
 
-    // TODO (feat): dbOptions.listeners
+    return napi_ok;
+  }
+
+ private:
+  rocksdb::Slice Element(size_t index) const {
+    return rocksdb::Slice(data_.data() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+  }
+
+  Database* database_;
+  rocksdb::ColumnFamilyHandle* column_;
+  const std::vector<QueryRange> queries_;
+  const bool keys_;
+  const bool values_;
+  const Encoding keyEncoding_;
+  const Encoding valueEncoding_;
+  const bool packed_;
+  const bool pooled_;
+  const rocksdb::ReadOptions readOptions_;
+  const std::shared_ptr<const rocksdb::Snapshot> snapshot_;
+
+  std::string data_;
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> ranges_;
+};
+
+NAPI_METHOD(db_query_many_sync) {
+  NAPI_ARGV(3);
+
+  auto query = QueryMany::create(env, argv[0], argv[1], argv[2]);
+  if (!query) {
+    return nullptr;
+  }
+
+  ROCKS_STATUS_THROWS_NAPI(query->Execute());
+
+  napi_value result;
+  NAPI_STATUS_THROWS(query->ConvertResult(env, result));
+
+  return result;
+}
+
+NAPI_METHOD(db_query_many) {
+  NAPI_ARGV(4);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  auto query = QueryMany::create(env, argv[0], argv[1], argv[2]);
+  if (!query) {
+    return nullptr;
+  }
+
+  napi_value resourceName;
+  NAPI_STATUS_THROWS(database->GetResourceName(env, ResourceLeveldownQueryMany, resourceName));
+
+  struct State {};
+
+  NAPI_STATUS_THROWS(runAsync<State>(
+      resourceName, env, argv[3], [query = query.get()](auto& state) { return query->Execute(); },
+      [query = std::move(query)](auto& state, napi_env env, napi_value* result) {
+        return query->ConvertResult(env, *result);
+      }));
+
+  return 0;
+}
+
+NAPI_METHOD(db_get_identity) {
+  NAPI_ARGV(1);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  if (!database->db) {
+    napi_throw_error(env, "LEVEL_DATABASE_NOT_OPEN", "Database is not open");
+    return NULL;
+  }
+
+  std::string identity;
+  ROCKS_STATUS_THROWS_NAPI(database->db->GetDbIdentity(identity));
+
+  napi_value result;
+  NAPI_STATUS_THROWS(Convert(env, identity, Encoding::String, result));
+
+  return result;
+}
+
+NAPI_METHOD(db_open) {
+  NAPI_ARGV(3);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  if (database->db) {
+    napi_value columns;
+    NAPI_STATUS_THROWS(napi_create_object(env, &columns));
+    for (auto& [id, column] : database->columns) {
+      napi_value val;
+      NAPI_STATUS_THROWS(napi_create_external(env, column.handle, nullptr, nullptr, &val));
+      NAPI_STATUS_THROWS(napi_set_named_property(env, columns, column.descriptor.name.c_str(), val));
+    }
+    return columns;
+  } else {
+    rocksdb::Options dbOptions;
+
+    const auto options = argv[1];
+
+    int parallelism = std::max<int>(1, std::thread::hardware_concurrency() / 2);
+    NAPI_STATUS_THROWS(GetProperty(env, options, "parallelism", parallelism));
+    dbOptions.IncreaseParallelism(parallelism);
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "walDir", dbOptions.wal_dir));
+
+    // 64-bit inputs: walTTL is in ms and walSizeLimit in bytes, so a 32-bit type
+    // wraps a >= ~4.3 GB size limit (or a ~49-day TTL) before the unit conversion.
+    uint64_t walTTL = 0;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "walTTL", walTTL));
+    dbOptions.WAL_ttl_seconds = static_cast<uint64_t>(std::ceil(walTTL / 1e3));
+
+    uint64_t walSizeLimit = 0;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "walSizeLimit", walSizeLimit));
+    dbOptions.WAL_size_limit_MB = static_cast<uint64_t>(std::ceil(walSizeLimit / 1e6));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "maxTotalWalSize", dbOptions.max_total_wal_size));
+
+    bool walCompression = true;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "walCompression", walCompression));
+    dbOptions.wal_compression =
+        walCompression ? rocksdb::CompressionType::kZSTD : rocksdb::CompressionType::kNoCompression;
+
+    dbOptions.avoid_unnecessary_blocking_io = true;
+    NAPI_STATUS_THROWS(
+        GetProperty(env, options, "avoidUnnecessaryBlockingIO", dbOptions.avoid_unnecessary_blocking_io));
+
+    dbOptions.create_missing_column_families = true;
+    NAPI_STATUS_THROWS(
+        GetProperty(env, options, "createMissingColumnFamilies", dbOptions.create_missing_column_families));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "writeDbIdToManifest", dbOptions.write_dbid_to_manifest));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "adviseRandomOnOpen", dbOptions.advise_random_on_open));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "bytesPerSync", dbOptions.bytes_per_sync));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "walBytesPerSync", dbOptions.wal_bytes_per_sync));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "strictBytesPerSync", dbOptions.strict_bytes_per_sync));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "delayedWriteRate", dbOptions.delayed_write_rate));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "createIfMissing", dbOptions.create_if_missing));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "errorIfExists", dbOptions.error_if_exists));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "pipelinedWrite", dbOptions.enable_pipelined_write));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "dailyOffpeakTime", dbOptions.daily_offpeak_time_utc));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "unorderedWrite", dbOptions.unordered_write));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "allowMmapReads", dbOptions.allow_mmap_reads));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "allowMmapWrites", dbOptions.allow_mmap_writes));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "memTableHugePageSize", dbOptions.memtable_huge_page_size));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "useDirectIOReads", dbOptions.use_direct_reads));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "useDirectIOForFlushAndCompaction",
+                                   dbOptions.use_direct_io_for_flush_and_compaction));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "compactionReadaheadSize", dbOptions.compaction_readahead_size));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "useAdaptiveMutex", dbOptions.use_adaptive_mutex));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "writeBufferSize", dbOptions.db_write_buffer_size));
+
+    NAPI_STATUS_THROWS(GetProperty(env, options, "manualWALFlush", dbOptions.manual_wal_flush));
+    NAPI_STATUS_THROWS(GetProperty(env, options, "walManualFlush", dbOptions.manual_wal_flush));
+
+    // TODO (feat): dbOptions.listeners
 
     std::string infoLogLevel;
     NAPI_STATUS_THROWS(GetProperty(env, options, "infoLogLevel", infoLogLevel));
@@ -1462,6 +2740,13 @@ NAPI_METHOD(db_open) {
 
     NAPI_STATUS_THROWS(InitOptions(env, dbOptions, options));
 
+    bool optimisticTransactions = false;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "optimisticTransactions", optimisticTransactions));
+
+    uint32_t iteratorPoolIdleTimeout = IteratorPool::kIdleTimeout.count();
+    NAPI_STATUS_THROWS(GetProperty(env, options, "iteratorPoolIdleTimeout", iteratorPoolIdleTimeout));
+    database->iterators.SetIdleTimeout(std::chrono::milliseconds(iteratorPoolIdleTimeout));
+
     std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
 
     bool hasColumns;
@@ -1501,10 +2786,23 @@ NAPI_METHOD(db_open) {
         [=](auto& handles) {
           assert(!database->db);
 
-          const auto status =
-              descriptors.empty()
-                  ? rocksdb::DB::Open(dbOptions, database->location, &database->db)
-                  : rocksdb::DB::Open(dbOptions, database->location, descriptors, &handles, &database->db);
+          std::unique_ptr<rocksdb::DB> db;
+          rocksdb::Status status;
+          if (optimisticTransactions) {
+            rocksdb::OptimisticTransactionDB* optimistic = nullptr;
+            status = descriptors.empty() ? rocksdb::OptimisticTransactionDB::Open(dbOptions, database->location,
+                                                                                   &optimistic)
+                                         : rocksdb::OptimisticTransactionDB::Open(dbOptions, database->location,
+                                                                                   descriptors, &handles, &optimistic);
+            db.reset(optimistic);
+            database->optimistic = optimistic;
+          } else {
+            status = descriptors.empty()
+                         ? rocksdb::DB::Open(dbOptions, database->location, &db)
+                         : rocksdb::DB::Open(dbOptions, database->location, descriptors, &handles, &db);
+          }
+
+          database->db = std::move(db);
 
           return status;
         },
@@ -1518,6 +2816,8 @@ NAPI_METHOD(db_open) {
             database->columns[column.handle->GetID()] = column;
           }
 
+          database->prefixExtractor = dbOptions.prefix_extractor;
+
           napi_value columns = *result;
           for (auto& [id, column] : database->columns) {
             napi_value val;
@@ -1548,14 +2848,17 @@ NAPI_METHOD(db_close) {
   return 0;
 }
 
-NAPI_METHOD(db_get_many_sync) {
+// Single-key counterpart of db_get_many_sync. Resolves to undefined if the key
+// is not found and null if the read was aborted or timed out, mirroring a
+// one-element getMany without the vectors and result array.
+NAPI_METHOD(db_get_sync) {
   NAPI_ARGV(3);
 
   Database* database;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
 
-  uint32_t count;
-  NAPI_STATUS_THROWS(napi_get_array_length(env, argv[1], &count));
+  rocksdb::PinnableSlice key;
+  NAPI_STATUS_THROWS(GetValue(env, argv[1], key));
 
   rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
   NAPI_STATUS_THROWS(GetProperty(env, argv[2], "column", column));
@@ -1569,19 +2872,6 @@ NAPI_METHOD(db_get_many_sync) {
   bool unsafe = false;
   NAPI_STATUS_THROWS(GetProperty(env, argv[2], "unsafe", unsafe));
 
-  std::vector<rocksdb::Slice> keys;
-  keys.resize(count);
-  std::vector<rocksdb::Status> statuses;
-  statuses.resize(count);
-  std::vector<rocksdb::PinnableSlice> values;
-  values.resize(count);
-
-  for (uint32_t n = 0; n < count; n++) {
-    napi_value element;
-    NAPI_STATUS_THROWS(napi_get_element(env, argv[1], n, &element));
-    NAPI_STATUS_THROWS(GetValue(env, element, keys[n]));
-  }
-
   rocksdb::ReadOptions readOptions;
   readOptions.deadline = timeout ? std::chrono::microseconds(database->db->GetEnv()->NowMicros() + timeout * 1000)
                                  : std::chrono::microseconds::zero();
@@ -1592,41 +2882,33 @@ NAPI_METHOD(db_get_many_sync) {
   readOptions.async_io = true;
   NAPI_STATUS_THROWS(GetProperty(env, argv[2], "asyncIO", readOptions.async_io));
 
-  readOptions.optimize_multiget_for_io = true;
-  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "optimizeMultigetForIO", readOptions.optimize_multiget_for_io));
-
-  readOptions.value_size_soft_limit = std::numeric_limits<int32_t>::max();
-  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "highWaterMarkBytes", readOptions.value_size_soft_limit));
-
-  database->db->MultiGet(readOptions, column, count, keys.data(), values.data(), statuses.data());
+  std::shared_ptr<const rocksdb::Snapshot> snapshot;
+  NAPI_STATUS_THROWS(GetSnapshot(env, argv[2], readOptions, snapshot));
 
-  napi_value rows;
-  NAPI_STATUS_THROWS(napi_create_array_with_length(env, count, &rows));
+  rocksdb::PinnableSlice value;
+  const auto status = database->db->Get(readOptions, column, key, &value);
 
-  for (uint32_t n = 0; n < count; n++) {
-    napi_value row;
-    if (statuses[n].IsNotFound()) {
-      NAPI_STATUS_THROWS(napi_get_undefined(env, &row));
-    } else if (statuses[n].IsAborted() || statuses[n].IsTimedOut()) {
-      NAPI_STATUS_THROWS(napi_get_null(env, &row));
-    } else {
-      ROCKS_STATUS_THROWS_NAPI(statuses[n]);
-      NAPI_STATUS_THROWS(Convert(env, std::move(values[n]), valueEncoding, row, unsafe));
-    }
-    NAPI_STATUS_THROWS(napi_set_element(env, rows, n, row));
+  napi_value result;
+  if (status.IsNotFound()) {
+    NAPI_STATUS_THROWS(napi_get_undefined(env, &result));
+  } else if (status.IsAborted() || status.IsTimedOut()) {
+    NAPI_STATUS_THROWS(napi_get_null(env, &result));
+  } else {
+    ROCKS_STATUS_THROWS_NAPI(status);
+    NAPI_STATUS_THROWS(Convert(env, std::move(value), valueEncoding, result, unsafe));
   }
 
-  return rows;
+  return result;
 }
 
-NAPI_METHOD(db_get_many) {
+NAPI_METHOD(db_get) {
   NAPI_ARGV(4);
 
   Database* database;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
 
-  uint32_t count;
-  NAPI_STATUS_THROWS(napi_get_array_length(env, argv[1], &count));
+  std::string key;
+  NAPI_STATUS_THROWS(GetValue(env, argv[1], key));
 
   rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
   NAPI_STATUS_THROWS(GetProperty(env, argv[2], "column", column));
@@ -1634,95 +2916,900 @@ NAPI_METHOD(db_get_many) {
   Encoding valueEncoding = Encoding::Buffer;
   NAPI_STATUS_THROWS(GetProperty(env, argv[2], "valueEncoding", valueEncoding));
 
+  uint32_t timeout = 0;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "timeout", timeout));
+
   bool unsafe = false;
   NAPI_STATUS_THROWS(GetProperty(env, argv[2], "unsafe", unsafe));
 
   auto callback = argv[3];
 
-  std::vector<rocksdb::PinnableSlice> keys;
-  keys.resize(count);
-
-  for (uint32_t n = 0; n < count; n++) {
-    napi_value element;
-    NAPI_STATUS_THROWS(napi_get_element(env, argv[1], n, &element));
-    NAPI_STATUS_THROWS(GetValue(env, element, keys[n]));
-  }
-
   rocksdb::ReadOptions readOptions;
+  readOptions.deadline = timeout ? std::chrono::microseconds(database->db->GetEnv()->NowMicros() + timeout * 1000)
+                                 : std::chrono::microseconds::zero();
+
   readOptions.fill_cache = false;
   NAPI_STATUS_THROWS(GetProperty(env, argv[2], "fillCache", readOptions.fill_cache));
 
   readOptions.async_io = true;
   NAPI_STATUS_THROWS(GetProperty(env, argv[2], "asyncIO", readOptions.async_io));
 
-  readOptions.optimize_multiget_for_io = true;
-  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "optimizeMultigetForIO", readOptions.optimize_multiget_for_io));
-
-  readOptions.value_size_soft_limit = std::numeric_limits<int32_t>::max();
-  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "highWaterMarkBytes", readOptions.value_size_soft_limit));
+  std::shared_ptr<const rocksdb::Snapshot> snapshot;
+  NAPI_STATUS_THROWS(GetSnapshot(env, argv[2], readOptions, snapshot));
 
   napi_value resourceName;
-  NAPI_STATUS_THROWS(database->GetResourceName(env, ResourceLeveldownGetMany, resourceName));
+  NAPI_STATUS_THROWS(database->GetResourceName(env, ResourceLeveldownGet, resourceName));
 
   struct State {
-    std::vector<rocksdb::Status> statuses;
-    std::vector<rocksdb::PinnableSlice> values;
+    rocksdb::Status status;
+    rocksdb::PinnableSlice value;
   };
 
   NAPI_STATUS_THROWS(runAsync<State>(
       resourceName, env, callback,
-      [=, keys = std::move(keys), readOptions = std::move(readOptions)](auto& state) {
-        std::vector<rocksdb::Slice> keys2;
-        keys2.reserve(count);
-        for (uint32_t n = 0; n < count; n++) {
-          keys2.emplace_back(keys[n]);
-        }
-
-        state.statuses.resize(count);
-        state.values.resize(count);
-
-        database->db->MultiGet(readOptions, column, count, keys2.data(), state.values.data(), state.statuses.data());
-
+      [=, key = std::move(key), readOptions = std::move(readOptions), snapshot = std::move(snapshot)](auto& state) {
+        state.status = database->db->Get(readOptions, column, key, &state.value);
         return rocksdb::Status::OK();
       },
       [=](auto& state, napi_env env, napi_value* result) {
-        NAPI_STATUS_RETURN(napi_create_array_with_length(env, count, result));
-
-        for (uint32_t n = 0; n < count; n++) {
-          napi_value row;
-          if (state.statuses[n].IsNotFound()) {
-            NAPI_STATUS_RETURN(napi_get_undefined(env, &row));
-          } else if (state.statuses[n].IsAborted()) {
-            NAPI_STATUS_RETURN(napi_get_null(env, &row));
-          } else {
-            ROCKS_STATUS_RETURN_NAPI(state.statuses[n]);
-            NAPI_STATUS_RETURN(Convert(env, std::move(state.values[n]), valueEncoding, row, unsafe));
-          }
-          NAPI_STATUS_RETURN(napi_set_element(env, *result, n, row));
+        if (state.status.IsNotFound()) {
+          return napi_get_undefined(env, result);
+        } else if (state.status.IsAborted() || state.status.IsTimedOut()) {
+          return napi_get_null(env, result);
         }
-
-        return napi_ok;
+        ROCKS_STATUS_RETURN_NAPI(state.status);
+        return Convert(env, std::move(state.value), valueEncoding, *result, unsafe);
       }));
 
   return 0;
 }
 
-NAPI_METHOD(db_clear) {
-  NAPI_ARGV(2);
+// Writes `value` prefixed with `rev` (one length byte, then the revision, as
+// read by `valueSlice: { lengthPrefix: 1 }`) unless the stored value's
+// revision is the same or newer, ordered by compareRev. The read and the write
+// happen under a per-key lock in one threadpool task. Results in whether the
+// value was written.
+NAPI_METHOD(db_put_if_newer) {
+  NAPI_ARGV(6);
 
   Database* database;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
 
-  const auto options = argv[1];
+  std::string key;
+  NAPI_STATUS_THROWS(GetValue(env, argv[1], key));
 
-  bool reverse = false;
-  NAPI_STATUS_THROWS(GetProperty(env, options, "reverse", reverse));
+  std::string rev;
+  NAPI_STATUS_THROWS(GetValue(env, argv[2], rev));
 
-  int32_t limit = -1;
-  NAPI_STATUS_THROWS(GetProperty(env, options, "limit", limit));
+  if (rev.empty() || rev.size() > 255) {
+    napi_throw_range_error(env, "LEVEL_INVALID_VALUE", "Revision must be 1 to 255 bytes");
+    return nullptr;
+  }
 
-  rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
-  NAPI_STATUS_THROWS(GetProperty(env, options, "column", column));
+  rocksdb::Slice value;
+  NAPI_STATUS_THROWS(GetValue(env, argv[3], value));
+
+  std::string data;
+  data.reserve(1 + rev.size() + value.size());
+  data.push_back(static_cast<char>(rev.size()));
+  data.append(rev);
+  data.append(value.data(), value.size());
+
+  rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[4], "column", column));
+
+  rocksdb::WriteOptions writeOptions;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[4], "sync", writeOptions.sync));
+
+  auto callback = argv[5];
+
+  napi_value resourceName;
+  NAPI_STATUS_THROWS(database->GetResourceName(env, ResourceLeveldownPutIfNewer, resourceName));
+
+  struct State {
+    bool written = false;
+  };
+
+  NAPI_STATUS_THROWS(runAsync<State>(
+      resourceName, env, callback,
+      [=, key = std::move(key), data = std::move(data)](auto& state) {
+        const auto stripe = std::hash<std::string_view>{}(key) % database->revLocks.size();
+        std::lock_guard<std::mutex> lock(database->revLocks[stripe]);
+
+        rocksdb::ReadOptions readOptions;
+        readOptions.fill_cache = false;
+
+        rocksdb::PinnableSlice current;
+        const auto status = database->db->Get(readOptions, column, key, &current);
+        if (status.ok()) {
+          if (compareRev(current, data) >= 0) {
+            return rocksdb::Status::OK();
+          }
+        } else if (!status.IsNotFound()) {
+          return status;
+        }
+
+        ROCKS_STATUS_RETURN(database->db->Put(writeOptions, column, key, data));
+        state.written = true;
+        return rocksdb::Status::OK();
+      },
+      [=](auto& state, napi_env env, napi_value* result) { return napi_get_boolean(env, state.written, result); }));
+
+  return 0;
+}
+
+static napi_status ConvertCount(napi_env env,
+                                uint64_t count,
+                                uint64_t keyBytes,
+                                uint64_t valueBytes,
+                                napi_value& result) {
+  NAPI_STATUS_RETURN(napi_create_object(env, &result));
+
+  napi_value value;
+  NAPI_STATUS_RETURN(napi_create_double(env, static_cast<double>(count), &value));
+  NAPI_STATUS_RETURN(napi_set_named_property(env, result, "count", value));
+
+  NAPI_STATUS_RETURN(napi_create_double(env, static_cast<double>(keyBytes), &value));
+  NAPI_STATUS_RETURN(napi_set_named_property(env, result, "keyBytes", value));
+
+  NAPI_STATUS_RETURN(napi_create_double(env, static_cast<double>(valueBytes), &value));
+  NAPI_STATUS_RETURN(napi_set_named_property(env, result, "valueBytes", value));
+
+  return napi_ok;
+}
+
+NAPI_METHOD(db_count_sync) {
+  NAPI_ARGV(2);
+
+  try {
+    auto iterator = Iterator::create(env, argv[0], argv[1]);
+    if (!iterator) {
+      return nullptr;
+    }
+
+    uint64_t count = 0;
+    uint64_t keyBytes = 0;
+    uint64_t valueBytes = 0;
+    ROCKS_STATUS_THROWS_NAPI(iterator->Count(count, keyBytes, valueBytes));
+
+    napi_value result;
+    NAPI_STATUS_THROWS(ConvertCount(env, count, keyBytes, valueBytes, result));
+    return result;
+  } catch (const std::exception& e) {
+    napi_throw_error(env, nullptr, e.what());
+    return nullptr;
+  }
+}
+
+NAPI_METHOD(db_count) {
+  NAPI_ARGV(3);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  std::unique_ptr<Iterator> iterator;
+  try {
+    iterator = Iterator::create(env, argv[0], argv[1]);
+    if (!iterator) {
+      return nullptr;
+    }
+  } catch (const std::exception& e) {
+    napi_throw_error(env, nullptr, e.what());
+    return nullptr;
+  }
+
+  auto callback = argv[2];
+
+  napi_value resourceName;
+  NAPI_STATUS_THROWS(database->GetResourceName(env, ResourceLeveldownCount, resourceName));
+
+  struct State {
+    uint64_t count = 0;
+    uint64_t keyBytes = 0;
+    uint64_t valueBytes = 0;
+  };
+
+  NAPI_STATUS_THROWS(runAsync<State>(
+      resourceName, env, callback,
+      [iterator = std::move(iterator)](auto& state) {
+        return iterator->Count(state.count, state.keyBytes, state.valueBytes);
+      },
+      [](auto& state, napi_env env, napi_value* result) {
+        return ConvertCount(env, state.count, state.keyBytes, state.valueBytes, *result);
+      }));
+
+  return 0;
+}
+
+// Narrows found values to `valueSlice` before they are copied out.
+static void ProjectValues(const ValueSlice& valueSlice,
+                          const rocksdb::Status* statuses,
+                          rocksdb::PinnableSlice* values,
+                          size_t count) {
+  for (size_t n = 0; n < count; n++) {
+    if (statuses[n].ok()) {
+      valueSlice.Apply(values[n]);
+    }
+  }
+}
+
+// format: 'packed' returns the values of a getMany as one slab plus an index
+// (Uint32Array) instead of one Buffer per hit. The index holds count + 1
+// offsets (value n spans [offsets[n], offsets[n + 1])) followed by two bitmaps
+// of ceil(count / 32) words each: keys that were found, and keys that were
+// aborted or timed out (null in the rows format). Keys in neither were not
+// found.
+static size_t PackedIndexSize(size_t count) {
+  return count + 1 + 2 * ((count + 31) / 32);
+}
+
+static rocksdb::Status IndexValues(const rocksdb::Status* statuses,
+                                   const rocksdb::PinnableSlice* values,
+                                   size_t count,
+                                   uint32_t* index,
+                                   size_t& size) {
+  const auto words = (count + 31) / 32;
+  auto found = index + count + 1;
+  auto incomplete = found + words;
+  std::fill(found, incomplete + words, 0);
+
+  size = 0;
+  for (size_t n = 0; n < count; n++) {
+    index[n] = static_cast<uint32_t>(size);
+    if (statuses[n].IsNotFound()) {
+      // Do nothing...
+    } else if (statuses[n].IsAborted() || statuses[n].IsTimedOut() ||
+               size + values[n].size() > std::numeric_limits<uint32_t>::max()) {
+      incomplete[n / 32] |= 1u << (n % 32);
+    } else {
+      ROCKS_STATUS_RETURN(statuses[n]);
+      found[n / 32] |= 1u << (n % 32);
+      size += values[n].size();
+    }
+  }
+  index[count] = static_cast<uint32_t>(size);
+
+  return rocksdb::Status::OK();
+}
+
+static void CopyValues(const rocksdb::PinnableSlice* values, size_t count, const uint32_t* index, char* data) {
+  const auto found = index + count + 1;
+  for (size_t n = 0; n < count; n++) {
+    if (found[n / 32] & (1u << (n % 32))) {
+      memcpy(data + index[n], values[n].data(), values[n].size());
+    }
+  }
+}
+
+// Returns { buffer, offsets } or, when the caller supplied its own `buffer` and
+// `offsets`, the number of value bytes. A caller buffer shorter than that is
+// left untouched (the offsets are still filled in) so the caller can retry with
+// a bigger one.
+static napi_status ConvertPacked(napi_env env,
+                                 const rocksdb::Status* statuses,
+                                 const rocksdb::PinnableSlice* values,
+                                 size_t count,
+                                 napi_value buffer,
+                                 napi_value offsets,
+                                 napi_value& result) {
+  size_t size = 0;
+
+  if (buffer || offsets) {
+    std::span<char> data;
+    NAPI_STATUS_RETURN(GetValue(env, buffer, data));
+
+    std::span<uint32_t> index;
+    NAPI_STATUS_RETURN(GetValue(env, offsets, index));
+
+    if (index.size() < PackedIndexSize(count)) {
+      return napi_invalid_arg;
+    }
+
+    ROCKS_STATUS_RETURN_NAPI(IndexValues(statuses, values, count, index.data(), size));
+    if (size <= data.size()) {
+      CopyValues(values, count, index.data(), data.data());
+    }
+
+    return napi_create_int64(env, size, &result);
+  }
+
+  std::vector<uint32_t> index(PackedIndexSize(count));
+  ROCKS_STATUS_RETURN_NAPI(IndexValues(statuses, values, count, index.data(), size));
+
+  std::string data;
+  data.resize_and_overwrite(size, [&](char* buf, size_t) {
+    CopyValues(values, count, index.data(), buf);
+    return size;
+  });
+
+  NAPI_STATUS_RETURN(napi_create_object(env, &result));
+
+  napi_value buffer2;
+  NAPI_STATUS_RETURN(ConvertExternal(env, std::move(data), buffer2));
+  NAPI_STATUS_RETURN(napi_set_named_property(env, result, "buffer", buffer2));
+
+  napi_value offsets2;
+  NAPI_STATUS_RETURN(ConvertExternal(env, std::move(index), offsets2));
+  NAPI_STATUS_RETURN(napi_set_named_property(env, result, "offsets", offsets2));
+
+  return napi_ok;
+}
+
+static napi_status GetPackedOutput(napi_env env, napi_value options, napi_value& buffer, napi_value& offsets) {
+  buffer = nullptr;
+  offsets = nullptr;
+
+  napi_valuetype type;
+  NAPI_STATUS_RETURN(napi_typeof(env, options, &type));
+  if (type != napi_object) {
+    return napi_ok;
+  }
+
+  bool hasBuffer = false;
+  NAPI_STATUS_RETURN(napi_has_named_property(env, options, "buffer", &hasBuffer));
+
+  bool hasOffsets = false;
+  NAPI_STATUS_RETURN(napi_has_named_property(env, options, "offsets", &hasOffsets));
+
+  if (hasBuffer != hasOffsets) {
+    return napi_invalid_arg;
+  }
+
+  if (hasBuffer) {
+    NAPI_STATUS_RETURN(napi_get_named_property(env, options, "buffer", &buffer));
+    NAPI_STATUS_RETURN(napi_get_named_property(env, options, "offsets", &offsets));
+  }
+
+  return napi_ok;
+}
+
+// Reads the keys of a getMany. Besides an array of buffers, the keys can cross
+// the boundary in one call as { buffer, offsets } (concatenated into one Buffer)
+// or { string, offsets } (concatenated into one string, with offsets counted in
+// UTF-16 code units and encoded to UTF-8 here). offsets holds count + 1
+// boundaries. Keys that are copied or encoded live in `storage`, which must
+// outlive `keys` and must not be modified afterwards.
+static napi_status GetKeys(napi_env env,
+                           napi_value value,
+                           const bool copy,
+                           std::string& storage,
+                           std::vector<rocksdb::Slice>& keys) {
+  bool isArray = false;
+  NAPI_STATUS_RETURN(napi_is_array(env, value, &isArray));
+
+  if (isArray) {
+    uint32_t count;
+    NAPI_STATUS_RETURN(napi_get_array_length(env, value, &count));
+
+    // Keys that end up in `storage` are recorded by position and only turned
+    // into slices once it is complete, since appending may reallocate it.
+    std::vector<std::pair<uint32_t, size_t>> stored;
+
+    keys.resize(count);
+    for (uint32_t n = 0; n < count; n++) {
+      napi_value element;
+      NAPI_STATUS_RETURN(napi_get_element(env, value, n, &element));
+
+      napi_valuetype type;
+      NAPI_STATUS_RETURN(napi_typeof(env, element, &type));
+
+      const auto pos = storage.size();
+      if (type == napi_string) {
+        size_t length = 0;
+        NAPI_STATUS_RETURN(napi_get_value_string_utf8(env, element, nullptr, 0, &length));
+        storage.resize(pos + length + 1);
+        NAPI_STATUS_RETURN(napi_get_value_string_utf8(env, element, storage.data() + pos, length + 1, &length));
+        storage.resize(pos + length);
+        keys[n] = rocksdb::Slice(nullptr, length);
+        stored.emplace_back(n, pos);
+      } else {
+        NAPI_STATUS_RETURN(GetValue(env, element, keys[n]));
+        if (copy) {
+          storage.append(keys[n].data(), keys[n].size());
+          stored.emplace_back(n, pos);
+        }
+      }
+    }
+
+    for (const auto& [n, pos] : stored) {
+      keys[n] = rocksdb::Slice(storage.data() + pos, keys[n].size());
+    }
+
+    return napi_ok;
+  }
+
+  napi_value offsetsValue;
+  NAPI_STATUS_RETURN(napi_get_named_property(env, value, "offsets", &offsetsValue));
+
+  std::span<uint32_t> offsets;
+  NAPI_STATUS_RETURN(GetValue(env, offsetsValue, offsets));
+
+  if (offsets.empty()) {
+    return napi_invalid_arg;
+  }
+
+  const size_t count = offsets.size() - 1;
+  for (size_t n = 0; n < count; n++) {
+    if (offsets[n] > offsets[n + 1]) {
+      return napi_invalid_arg;
+    }
+  }
+
+  bool hasBuffer = false;
+  NAPI_STATUS_RETURN(napi_has_named_property(env, value, "buffer", &hasBuffer));
+
+  if (hasBuffer) {
+    napi_value bufferValue;
+    NAPI_STATUS_RETURN(napi_get_named_property(env, value, "buffer", &bufferValue));
+
+    std::span<char> buffer;
+    NAPI_STATUS_RETURN(GetValue(env, bufferValue, buffer));
+
+    if (offsets[count] > buffer.size()) {
+      return napi_invalid_arg;
+    }
+
+    const char* data = buffer.data();
+    if (copy) {
+      storage.assign(buffer.data(), offsets[count]);
+      data = storage.data();
+    }
+
+    keys.resize(count);
+    for (size_t n = 0; n < count; n++) {
+      keys[n] = rocksdb::Slice(data + offsets[n], offsets[n + 1] - offsets[n]);
+    }
+
+    return napi_ok;
+  }
+
+  napi_value stringValue;
+  NAPI_STATUS_RETURN(napi_get_named_property(env, value, "string", &stringValue));
+
+  size_t length = 0;
+  NAPI_STATUS_RETURN(napi_get_value_string_utf16(env, stringValue, nullptr, 0, &length));
+
+  if (offsets[count] > length) {
+    return napi_invalid_arg;
+  }
+
+  std::u16string string;
+  napi_status status = napi_ok;
+  string.resize_and_overwrite(length, [&](char16_t* buf, size_t) {
+    status = napi_get_value_string_utf16(env, stringValue, buf, length + 1, &length);
+    return status == napi_ok ? length : 0;
+  });
+  NAPI_STATUS_RETURN(status);
+
+  std::vector<size_t> bounds(count + 1);
+  storage.clear();
+  storage.reserve(offsets[count]);
+  for (size_t n = 0; n < count; n++) {
+    bounds[n] = storage.size();
+    AppendUtf8(storage, string.data() + offsets[n], offsets[n + 1] - offsets[n]);
+  }
+  bounds[count] = storage.size();
+
+  keys.resize(count);
+  for (size_t n = 0; n < count; n++) {
+    keys[n] = rocksdb::Slice(storage.data() + bounds[n], bounds[n + 1] - bounds[n]);
+  }
+
+  return napi_ok;
+}
+
+NAPI_METHOD(db_get_many_sync) {
+  NAPI_ARGV(3);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  std::string storage;
+  std::vector<rocksdb::Slice> keys;
+  NAPI_STATUS_THROWS(GetKeys(env, argv[1], false, storage, keys));
+
+  const uint32_t count = keys.size();
+
+  rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "column", column));
+
+  Encoding valueEncoding = Encoding::Buffer;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "valueEncoding", valueEncoding));
+
+  uint32_t timeout = 0;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "timeout", timeout));
+
+  bool unsafe = false;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "unsafe", unsafe));
+
+  Format format = Format::Rows;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "format", format));
+
+  std::optional<ValueSlice> valueSlice;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "valueSlice", valueSlice));
+
+  std::vector<rocksdb::Status> statuses;
+  statuses.resize(count);
+  std::vector<rocksdb::PinnableSlice> values;
+  values.resize(count);
+
+  rocksdb::ReadOptions readOptions;
+  readOptions.deadline = timeout ? std::chrono::microseconds(database->db->GetEnv()->NowMicros() + timeout * 1000)
+                                 : std::chrono::microseconds::zero();
+
+  readOptions.fill_cache = false;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "fillCache", readOptions.fill_cache));
+
+  readOptions.async_io = true;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "asyncIO", readOptions.async_io));
+
+  readOptions.optimize_multiget_for_io = true;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "optimizeMultigetForIO", readOptions.optimize_multiget_for_io));
+
+  readOptions.value_size_soft_limit = std::numeric_limits<int32_t>::max();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "highWaterMarkBytes", readOptions.value_size_soft_limit));
+
+  std::shared_ptr<const rocksdb::Snapshot> snapshot;
+  NAPI_STATUS_THROWS(GetSnapshot(env, argv[2], readOptions, snapshot));
+
+  database->db->MultiGet(readOptions, column, count, keys.data(), values.data(), statuses.data());
+
+  if (valueSlice) {
+    ProjectValues(*valueSlice, statuses.data(), values.data(), count);
+  }
+
+  if (format == Format::Packed) {
+    napi_value buffer;
+    napi_value offsets;
+    NAPI_STATUS_THROWS(GetPackedOutput(env, argv[2], buffer, offsets));
+
+    napi_value result;
+    NAPI_STATUS_THROWS(ConvertPacked(env, statuses.data(), values.data(), count, buffer, offsets, result));
+    return result;
+  }
+
+  napi_value rows;
+  NAPI_STATUS_THROWS(napi_create_array_with_length(env, count, &rows));
+
+  for (uint32_t n = 0; n < count; n++) {
+    napi_value row;
+    if (statuses[n].IsNotFound()) {
+      NAPI_STATUS_THROWS(napi_get_undefined(env, &row));
+    } else if (statuses[n].IsAborted() || statuses[n].IsTimedOut()) {
+      NAPI_STATUS_THROWS(napi_get_null(env, &row));
+    } else {
+      ROCKS_STATUS_THROWS_NAPI(statuses[n]);
+      NAPI_STATUS_THROWS(Convert(env, std::move(values[n]), valueEncoding, row, unsafe));
+    }
+    NAPI_STATUS_THROWS(napi_set_element(env, rows, n, row));
+  }
+
+  return rows;
+}
+
+NAPI_METHOD(db_get_many) {
+  NAPI_ARGV(4);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  // Heap allocated so the key slices stay valid when it is moved to the worker.
+  auto storage = std::make_unique<std::string>();
+  std::vector<rocksdb::Slice> keys;
+  NAPI_STATUS_THROWS(GetKeys(env, argv[1], true, *storage, keys));
+
+  const uint32_t count = keys.size();
+
+  rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "column", column));
+
+  Encoding valueEncoding = Encoding::Buffer;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "valueEncoding", valueEncoding));
+
+  bool unsafe = false;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "unsafe", unsafe));
+
+  Format format = Format::Rows;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "format", format));
+
+  std::optional<ValueSlice> valueSlice;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "valueSlice", valueSlice));
+
+  // A caller-supplied packed output is only written on completion (on the JS
+  // thread), so it is merely kept alive while the MultiGet runs.
+  Reference bufferRef;
+  Reference offsetsRef;
+  bool hasOutput = false;
+  if (format == Format::Packed) {
+    napi_value buffer;
+    napi_value offsets;
+    NAPI_STATUS_THROWS(GetPackedOutput(env, argv[2], buffer, offsets));
+    if (buffer) {
+      NAPI_STATUS_THROWS(Reference::Create(env, buffer, bufferRef));
+      NAPI_STATUS_THROWS(Reference::Create(env, offsets, offsetsRef));
+      hasOutput = true;
+    }
+  }
+
+  auto callback = argv[3];
+
+  rocksdb::ReadOptions readOptions;
+  readOptions.fill_cache = false;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "fillCache", readOptions.fill_cache));
+
+  readOptions.async_io = true;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "asyncIO", readOptions.async_io));
+
+  readOptions.optimize_multiget_for_io = true;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "optimizeMultigetForIO", readOptions.optimize_multiget_for_io));
+
+  readOptions.value_size_soft_limit = std::numeric_limits<int32_t>::max();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "highWaterMarkBytes", readOptions.value_size_soft_limit));
+
+  std::shared_ptr<const rocksdb::Snapshot> snapshot;
+  NAPI_STATUS_THROWS(GetSnapshot(env, argv[2], readOptions, snapshot));
+
+  napi_value resourceName;
+  NAPI_STATUS_THROWS(database->GetResourceName(env, ResourceLeveldownGetMany, resourceName));
+
+  struct State {
+    std::vector<rocksdb::Status> statuses;
+    std::vector<rocksdb::PinnableSlice> values;
+  };
+
+  NAPI_STATUS_THROWS(runAsync<State>(
+      resourceName, env, callback,
+      [=, storage = std::move(storage), keys = std::move(keys), readOptions = std::move(readOptions),
+       snapshot = std::move(snapshot)](auto& state) {
+        state.statuses.resize(count);
+        state.values.resize(count);
+
+        database->db->MultiGet(readOptions, column, count, keys.data(), state.values.data(), state.statuses.data());
+
+        if (valueSlice) {
+          ProjectValues(*valueSlice, state.statuses.data(), state.values.data(), count);
+        }
+
+        return rocksdb::Status::OK();
+      },
+      [=, bufferRef = std::move(bufferRef), offsetsRef = std::move(offsetsRef)](auto& state, napi_env env,
+                                                                                 napi_value* result) {
+        if (format == Format::Packed) {
+          napi_value buffer = nullptr;
+          napi_value offsets = nullptr;
+          if (hasOutput) {
+            NAPI_STATUS_RETURN(bufferRef.Get(buffer));
+            NAPI_STATUS_RETURN(offsetsRef.Get(offsets));
+          }
+          return ConvertPacked(env, state.statuses.data(), state.values.data(), count, buffer, offsets, *result);
+        }
+
+        NAPI_STATUS_RETURN(napi_create_array_with_length(env, count, result));
+
+        for (uint32_t n = 0; n < count; n++) {
+          napi_value row;
+          if (state.statuses[n].IsNotFound()) {
+            NAPI_STATUS_RETURN(napi_get_undefined(env, &row));
+          } else if (state.statuses[n].IsAborted()) {
+            NAPI_STATUS_RETURN(napi_get_null(env, &row));
+          } else {
+            ROCKS_STATUS_RETURN_NAPI(state.statuses[n]);
+            NAPI_STATUS_RETURN(Convert(env, std::move(state.values[n]), valueEncoding, row, unsafe));
+          }
+          NAPI_STATUS_RETURN(napi_set_element(env, *result, n, row));
+        }
+
+        return napi_ok;
+      }));
+
+  return 0;
+}
+
+// Looks up the entry nearest to each key: the last one at or before it (a
+// floor, with `reverse`) or the first one at or after it (a ceiling). Reads of
+// the latest state use a pooled iterator, unless the column has a prefix
+// extractor.
+class GetNearest {
+ public:
+  GetNearest(Database* database,
+             rocksdb::ColumnFamilyHandle* column,
+             std::unique_ptr<std::string> storage,
+             std::vector<rocksdb::Slice>&& keys,
+             const bool reverse,
+             const Encoding keyEncoding,
+             const Encoding valueEncoding,
+             rocksdb::ReadOptions readOptions,
+             std::shared_ptr<const rocksdb::Snapshot> snapshot)
+      : database_(database),
+        column_(column),
+        storage_(std::move(storage)),
+        keys_(std::move(keys)),
+        reverse_(reverse),
+        keyEncoding_(keyEncoding),
+        valueEncoding_(valueEncoding),
+        pooled_(IteratorPool::Poolable(readOptions)),
+        readOptions_(readOptions),
+        snapshot_(std::move(snapshot)) {}
+
+  static std::unique_ptr<GetNearest> create(napi_env env, napi_value db, napi_value keys, napi_value options) {
+    Database* database;
+    NAPI_STATUS_THROWS(napi_get_value_external(env, db, reinterpret_cast<void**>(&database)));
+
+    // Heap allocated so the key slices stay valid when this is moved.
+    auto storage = std::make_unique<std::string>();
+    std::vector<rocksdb::Slice> keys2;
+    NAPI_STATUS_THROWS(GetKeys(env, keys, true, *storage, keys2));
+
+    rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+    NAPI_STATUS_THROWS(GetProperty(env, options, "column", column));
+
+    bool reverse = false;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "reverse", reverse));
+
+    Encoding keyEncoding = Encoding::Buffer;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "keyEncoding", keyEncoding));
+
+    Encoding valueEncoding = Encoding::Buffer;
+    NAPI_STATUS_THROWS(GetProperty(env, options, "valueEncoding", valueEncoding));
+
+    auto readOptions = IteratorPool::Defaults();
+    NAPI_STATUS_THROWS(GetProperty(env, options, "fillCache", readOptions.fill_cache));
+    NAPI_STATUS_THROWS(GetProperty(env, options, "asyncIO", readOptions.async_io));
+
+    // The nearest entry may have another prefix, which a prefix mode seek can
+    // skip. Such iterators are not pooled.
+    readOptions.total_order_seek = database->PrefixExtractor(column) != nullptr;
+
+    std::shared_ptr<const rocksdb::Snapshot> snapshot;
+    NAPI_STATUS_THROWS(GetSnapshot(env, options, readOptions, snapshot));
+
+    return std::make_unique<GetNearest>(database, column, std::move(storage), std::move(keys2), reverse, keyEncoding,
+                                        valueEncoding, readOptions, std::move(snapshot));
+  }
+
+  rocksdb::Status Execute() {
+    IteratorPool::Entry entry;
+    if (pooled_) {
+      entry = database_->iterators.Acquire(database_->db.get(), column_);
+    } else {
+      entry.iterator.reset(database_->db->NewIterator(readOptions_, column_));
+    }
+    auto& iterator = entry.iterator;
+
+    offsets_.push_back(0);
+    found_.resize(keys_.size());
+
+    for (size_t n = 0; n < keys_.size(); n++) {
+      if (reverse_) {
+        iterator->SeekForPrev(keys_[n]);
+      } else {
+        iterator->Seek(keys_[n]);
+      }
+
+      if (iterator->Valid()) {
+        const auto key = iterator->key();
+        const auto value = iterator->value();
+        data_.append(key.data(), key.size());
+        offsets_.push_back(data_.size());
+        data_.append(value.data(), value.size());
+        offsets_.push_back(data_.size());
+        found_[n] = true;
+      } else {
+        ROCKS_STATUS_RETURN(iterator->status());
+        offsets_.push_back(data_.size());
+        offsets_.push_back(data_.size());
+      }
+    }
+
+    if (pooled_) {
+      database_->iterators.Release(column_, std::move(entry));
+    }
+
+    return rocksdb::Status::OK();
+  }
+
+  // Flat [key, value, ...] rows, one pair per lookup, with undefined for both
+  // when there is no such entry.
+  napi_status ConvertResult(napi_env env, napi_value& result) const {
+    NAPI_STATUS_RETURN(napi_create_array_with_length(env, keys_.size() * 2, &result));
+
+    for (size_t n = 0; n < keys_.size(); n++) {
+      napi_value key;
+      napi_value val;
+
+      if (found_[n]) {
+        NAPI_STATUS_RETURN(Convert(env, Element(n * 2), keyEncoding_, key));
+        NAPI_STATUS_RETURN(Convert(env, Element(n * 2 + 1), valueEncoding_, val));
+      } else {
+        NAPI_STATUS_RETURN(napi_get_undefined(env, &key));
+        NAPI_STATUS_RETURN(napi_get_undefined(env, &val));
+      }
+
+      NAPI_STATUS_RETURN(napi_set_element(env, result, n * 2 + 0, key));
+      NAPI_STATUS_RETURN(napi_set_element(env, result, n * 2 + 1, val));
+    }
+
+    return napi_ok;
+  }
+
+ private:
+  rocksdb::Slice Element(size_t index) const {
+    return rocksdb::Slice(data_.data() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+  }
+
+  Database* database_;
+  rocksdb::ColumnFamilyHandle* column_;
+  const std::unique_ptr<std::string> storage_;
+  const std::vector<rocksdb::Slice> keys_;
+  const bool reverse_;
+  const Encoding keyEncoding_;
+  const Encoding valueEncoding_;
+  const bool pooled_;
+  const rocksdb::ReadOptions readOptions_;
+  const std::shared_ptr<const rocksdb::Snapshot> snapshot_;
+
+  std::string data_;
+  std::vector<size_t> offsets_;
+  std::vector<bool> found_;
+};
+
+NAPI_METHOD(db_get_nearest_sync) {
+  NAPI_ARGV(3);
+
+  auto lookup = GetNearest::create(env, argv[0], argv[1], argv[2]);
+  if (!lookup) {
+    return nullptr;
+  }
+
+  ROCKS_STATUS_THROWS_NAPI(lookup->Execute());
+
+  napi_value result;
+  NAPI_STATUS_THROWS(lookup->ConvertResult(env, result));
+
+  return result;
+}
+
+NAPI_METHOD(db_get_nearest) {
+  NAPI_ARGV(4);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  auto lookup = GetNearest::create(env, argv[0], argv[1], argv[2]);
+  if (!lookup) {
+    return nullptr;
+  }
+
+  napi_value resourceName;
+  NAPI_STATUS_THROWS(database->GetResourceName(env, ResourceLeveldownGetNearest, resourceName));
+
+  struct State {};
+
+  NAPI_STATUS_THROWS(runAsync<State>(
+      resourceName, env, argv[3], [lookup = lookup.get()](auto& state) { return lookup->Execute(); },
+      [lookup = std::move(lookup)](auto& state, napi_env env, napi_value* result) {
+        return lookup->ConvertResult(env, *result);
+      }));
+
+  return 0;
+}
+
+NAPI_METHOD(db_clear) {
+  NAPI_ARGV(2);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  const auto options = argv[1];
+
+  bool reverse = false;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "reverse", reverse));
+
+  int32_t limit = -1;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "limit", limit));
+
+  rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, options, "column", column));
 
   std::optional<std::string> lt;
   NAPI_STATUS_THROWS(GetProperty(env, options, "lt", lt));
@@ -1833,6 +3920,252 @@ NAPI_METHOD(db_get_property) {
   return result;
 }
 
+// Picks up to `count - 1` keys that split [gte, lt) into ranges holding
+// roughly the same number of SST bytes, using the smallest key of each live
+// file as a candidate boundary. Memtable data is not taken into account.
+NAPI_METHOD(db_get_range_splits) {
+  NAPI_ARGV(2);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  if (!database->db) {
+    napi_throw_error(env, "LEVEL_DATABASE_NOT_OPEN", "Database is not open");
+    return NULL;
+  }
+
+  rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[1], "column", column));
+
+  std::optional<std::string> gte;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[1], "gte", gte));
+
+  std::optional<std::string> lt;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[1], "lt", lt));
+
+  uint32_t count = 1;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[1], "count", count));
+
+  Encoding keyEncoding = Encoding::Buffer;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[1], "keyEncoding", keyEncoding));
+
+  const auto comparator = column->GetComparator();
+
+  std::vector<rocksdb::LiveFileMetaData> files;
+  database->db->GetLiveFilesMetaData(&files);
+
+  std::vector<std::pair<std::string, uint64_t>> candidates;
+  uint64_t total = 0;
+  for (auto& file : files) {
+    if (file.column_family_name != column->GetName()) {
+      continue;
+    }
+    if ((gte && comparator->Compare(file.largestkey, *gte) < 0) ||
+        (lt && comparator->Compare(file.smallestkey, *lt) >= 0)) {
+      continue;
+    }
+    total += file.size;
+    if ((!gte || comparator->Compare(file.smallestkey, *gte) > 0)) {
+      candidates.emplace_back(std::move(file.smallestkey), file.size);
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [&](const auto& a, const auto& b) { return comparator->Compare(a.first, b.first) < 0; });
+
+  napi_value result;
+  NAPI_STATUS_THROWS(napi_create_array(env, &result));
+
+  uint32_t idx = 0;
+  uint64_t bytes = 0;
+  const std::string* last = nullptr;
+  for (const auto& [key, size] : candidates) {
+    if (idx + 1 >= count) {
+      break;
+    }
+
+    // A candidate closes the range before it once that holds its share.
+    if (bytes >= total * (idx + 1) / count && (!last || comparator->Compare(key, *last) != 0)) {
+      napi_value element;
+      NAPI_STATUS_THROWS(Convert(env, key, keyEncoding, element));
+      NAPI_STATUS_THROWS(napi_set_element(env, result, idx++, element));
+      last = &key;
+    }
+
+    bytes += size;
+  }
+
+  return result;
+}
+
+// Reads an array of { gt(e), lt(e) } ranges into [start, limit) pairs, with
+// exclusive lower and inclusive upper bounds adjusted the way BaseIterator
+// does. A range must have an upper bound.
+static napi_status GetRanges(napi_env env, napi_value value, std::vector<std::pair<std::string, std::string>>& ranges) {
+  uint32_t length;
+  NAPI_STATUS_RETURN(napi_get_array_length(env, value, &length));
+
+  ranges.resize(length);
+  for (uint32_t n = 0; n < length; n++) {
+    napi_value element;
+    NAPI_STATUS_RETURN(napi_get_element(env, value, n, &element));
+
+    std::optional<std::string> gt;
+    NAPI_STATUS_RETURN(GetProperty(env, element, "gt", gt));
+
+    std::optional<std::string> gte;
+    NAPI_STATUS_RETURN(GetProperty(env, element, "gte", gte));
+
+    std::optional<std::string> lt;
+    NAPI_STATUS_RETURN(GetProperty(env, element, "lt", lt));
+
+    std::optional<std::string> lte;
+    NAPI_STATUS_RETURN(GetProperty(env, element, "lte", lte));
+
+    auto& [start, limit] = ranges[n];
+    if (gte) {
+      start = std::move(*gte);
+    } else if (gt) {
+      start = std::move(*gt) + '\0';
+    }
+
+    if (lt) {
+      limit = std::move(*lt);
+    } else if (lte) {
+      limit = std::move(*lte) + '\0';
+    } else {
+      return napi_invalid_arg;
+    }
+  }
+
+  return napi_ok;
+}
+
+NAPI_METHOD(db_get_approximate_sizes) {
+  NAPI_ARGV(3);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  if (!database->db) {
+    napi_throw_error(env, "LEVEL_DATABASE_NOT_OPEN", "Database is not open");
+    return NULL;
+  }
+
+  std::vector<std::pair<std::string, std::string>> bounds;
+  NAPI_STATUS_THROWS(GetRanges(env, argv[1], bounds));
+
+  rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "column", column));
+
+  rocksdb::SizeApproximationOptions sizeOptions;
+
+  sizeOptions.include_memtables = true;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "includeMemtables", sizeOptions.include_memtables));
+
+  sizeOptions.include_files = true;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "includeFiles", sizeOptions.include_files));
+
+  std::vector<rocksdb::Range> ranges;
+  ranges.reserve(bounds.size());
+  for (const auto& [start, limit] : bounds) {
+    ranges.emplace_back(start, limit);
+  }
+
+  std::vector<uint64_t> sizes(ranges.size());
+  ROCKS_STATUS_THROWS_NAPI(
+      database->db->GetApproximateSizes(sizeOptions, column, ranges.data(), ranges.size(), sizes.data()));
+
+  napi_value result;
+  NAPI_STATUS_THROWS(napi_create_array_with_length(env, sizes.size(), &result));
+
+  for (size_t n = 0; n < sizes.size(); n++) {
+    napi_value size;
+    NAPI_STATUS_THROWS(napi_create_double(env, static_cast<double>(sizes[n]), &size));
+    NAPI_STATUS_THROWS(napi_set_element(env, result, n, size));
+  }
+
+  return result;
+}
+
+// Estimates the number of entries per range as the memtable's approximate
+// count (GetApproximateMemTableStats, itself an estimate) plus the range's SST
+// bytes divided by the column's average SST entry size.
+NAPI_METHOD(db_get_approximate_counts) {
+  NAPI_ARGV(3);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  if (!database->db) {
+    napi_throw_error(env, "LEVEL_DATABASE_NOT_OPEN", "Database is not open");
+    return NULL;
+  }
+
+  std::vector<std::pair<std::string, std::string>> bounds;
+  NAPI_STATUS_THROWS(GetRanges(env, argv[1], bounds));
+
+  rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "column", column));
+
+  std::vector<rocksdb::LiveFileMetaData> files;
+  database->db->GetLiveFilesMetaData(&files);
+
+  uint64_t fileBytes = 0;
+  uint64_t fileEntries = 0;
+  for (const auto& file : files) {
+    if (file.column_family_name == column->GetName()) {
+      fileBytes += file.size;
+      fileEntries += file.num_entries;
+    }
+  }
+
+  std::vector<rocksdb::Range> ranges;
+  ranges.reserve(bounds.size());
+  for (const auto& [start, limit] : bounds) {
+    ranges.emplace_back(start, limit);
+  }
+
+  std::vector<uint64_t> sizes(ranges.size());
+  if (fileEntries > 0) {
+    rocksdb::SizeApproximationOptions sizeOptions;
+    sizeOptions.include_memtables = false;
+    sizeOptions.include_files = true;
+    ROCKS_STATUS_THROWS_NAPI(
+        database->db->GetApproximateSizes(sizeOptions, column, ranges.data(), ranges.size(), sizes.data()));
+  }
+
+  napi_value result;
+  NAPI_STATUS_THROWS(napi_create_array_with_length(env, ranges.size(), &result));
+
+  for (size_t n = 0; n < ranges.size(); n++) {
+    uint64_t memtableCount = 0;
+    uint64_t memtableSize = 0;
+    database->db->GetApproximateMemTableStats(column, ranges[n], &memtableCount, &memtableSize);
+
+    const double fileCount =
+        fileEntries > 0 ? static_cast<double>(sizes[n]) * fileEntries / std::max<uint64_t>(fileBytes, 1) : 0;
+
+    napi_value count;
+    NAPI_STATUS_THROWS(napi_create_double(env, std::round(memtableCount + fileCount), &count));
+    NAPI_STATUS_THROWS(napi_set_element(env, result, n, count));
+  }
+
+  return result;
+}
+
+NAPI_METHOD(db_get_idle_iterators) {
+  NAPI_ARGV(1);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  napi_value result;
+  NAPI_STATUS_THROWS(napi_create_uint32(env, database->iterators.Size(), &result));
+
+  return result;
+}
+
 NAPI_METHOD(db_get_latest_sequence) {
   NAPI_ARGV(1);
 
@@ -1863,10 +4196,53 @@ NAPI_METHOD(db_flush_wal) {
 
   auto callback = argv[2];
 
-  napi_value resourceName;
-  NAPI_STATUS_THROWS(database->GetResourceName(env, ResourceLeveldownFlushWal, resourceName));
+  napi_value resourceName;
+  NAPI_STATUS_THROWS(database->GetResourceName(env, ResourceLeveldownFlushWal, resourceName));
+
+  NAPI_STATUS_THROWS(runAsync(resourceName, env, callback, [=](auto& state) { return database->db->FlushWAL(sync); }));
+
+  return 0;
+}
+
+NAPI_METHOD(snapshot_init) {
+  NAPI_ARGV(1);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  if (!database->db) {
+    napi_throw_error(env, "LEVEL_DATABASE_NOT_OPEN", "Database is not open");
+    return NULL;
+  }
+
+  auto snapshot = std::make_unique<Snapshot>(database);
+
+  napi_value result;
+  NAPI_STATUS_THROWS(napi_create_external(env, snapshot.get(), Finalize<Snapshot>, snapshot.get(), &result));
+  snapshot.release();
+
+  return result;
+}
+
+NAPI_METHOD(snapshot_get_sequence) {
+  NAPI_ARGV(1);
+
+  Snapshot* snapshot;
+  NAPI_STATUS_THROWS(GetValue(env, argv[0], snapshot));
+
+  napi_value result;
+  NAPI_STATUS_THROWS(napi_create_int64(env, snapshot->snapshot_->GetSequenceNumber(), &result));
+
+  return result;
+}
+
+NAPI_METHOD(snapshot_close) {
+  NAPI_ARGV(1);
+
+  Snapshot* snapshot;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&snapshot)));
 
-  NAPI_STATUS_THROWS(runAsync(resourceName, env, callback, [=](auto& state) { return database->db->FlushWAL(sync); }));
+  ROCKS_STATUS_THROWS_NAPI(snapshot->Close());
 
   return 0;
 }
@@ -1993,6 +4369,29 @@ NAPI_METHOD(iterator_nextv) {
   }
 }
 
+NAPI_METHOD(iterator_seek_nextv) {
+  NAPI_ARGV(5);
+
+  try {
+    Iterator* iterator;
+    NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&iterator)));
+
+    std::string target;
+    NAPI_STATUS_THROWS(GetValue(env, argv[1], target));
+
+    uint32_t count = 1024;
+    NAPI_STATUS_THROWS(GetValue(env, argv[2], count));
+
+    uint32_t timeout = 0;
+    NAPI_STATUS_THROWS(GetProperty(env, argv[3], "timeout", timeout));
+
+    return iterator->nextv(env, count, timeout, argv[4], std::move(target));
+  } catch (const std::exception& e) {
+    napi_throw_error(env, nullptr, e.what());
+    return nullptr;
+  }
+}
+
 NAPI_METHOD(iterator_nextv_sync) {
   NAPI_ARGV(3);
 
@@ -2014,10 +4413,23 @@ NAPI_METHOD(iterator_nextv_sync) {
 }
 
 NAPI_METHOD(batch_init) {
-  auto batch = std::make_unique<rocksdb::WriteBatch>();
+  NAPI_ARGV(2);
+
+  bool indexed = false;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[1], "indexed", indexed));
+
+  std::unique_ptr<Batch> batch;
+  if (indexed) {
+    Database* database;
+    NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+    batch = std::make_unique<Batch>(database->db->DefaultColumnFamily()->GetComparator());
+  } else {
+    batch = std::make_unique<Batch>();
+  }
 
   napi_value result;
-  NAPI_STATUS_THROWS(napi_create_external(env, batch.get(), Finalize<rocksdb::WriteBatch>, batch.get(), &result));
+  NAPI_STATUS_THROWS(napi_create_external(env, batch.get(), Finalize<Batch>, batch.get(), &result));
   batch.release();
 
   return result;
@@ -2026,7 +4438,7 @@ NAPI_METHOD(batch_init) {
 NAPI_METHOD(batch_put) {
   NAPI_ARGV(4);
 
-  rocksdb::WriteBatch* batch;
+  Batch* batch;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&batch)));
 
   rocksdb::Slice key;
@@ -2039,9 +4451,9 @@ NAPI_METHOD(batch_put) {
   NAPI_STATUS_THROWS(GetProperty(env, argv[3], "column", column));
 
   if (column) {
-    ROCKS_STATUS_THROWS_NAPI(batch->Put(column, key, val));
+    ROCKS_STATUS_THROWS_NAPI(batch->base->Put(column, key, val));
   } else {
-    ROCKS_STATUS_THROWS_NAPI(batch->Put(key, val));
+    ROCKS_STATUS_THROWS_NAPI(batch->base->Put(key, val));
   }
 
   return 0;
@@ -2050,13 +4462,13 @@ NAPI_METHOD(batch_put) {
 NAPI_METHOD(batch_put_log_data) {
   NAPI_ARGV(2);
 
-  rocksdb::WriteBatch* batch;
+  Batch* batch;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&batch)));
 
   rocksdb::Slice blob;
   NAPI_STATUS_THROWS(GetValue(env, argv[1], blob));
 
-  ROCKS_STATUS_THROWS_NAPI(batch->PutLogData(blob));
+  ROCKS_STATUS_THROWS_NAPI(batch->base->PutLogData(blob));
 
   return 0;
 }
@@ -2064,7 +4476,7 @@ NAPI_METHOD(batch_put_log_data) {
 NAPI_METHOD(batch_del) {
   NAPI_ARGV(3);
 
-  rocksdb::WriteBatch* batch;
+  Batch* batch;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&batch)));
 
   rocksdb::Slice key;
@@ -2074,9 +4486,9 @@ NAPI_METHOD(batch_del) {
   NAPI_STATUS_THROWS(GetProperty(env, argv[2], "column", column));
 
   if (column) {
-    ROCKS_STATUS_THROWS_NAPI(batch->Delete(column, key));
+    ROCKS_STATUS_THROWS_NAPI(batch->base->Delete(column, key));
   } else {
-    ROCKS_STATUS_THROWS_NAPI(batch->Delete(key));
+    ROCKS_STATUS_THROWS_NAPI(batch->base->Delete(key));
   }
 
   return 0;
@@ -2085,7 +4497,7 @@ NAPI_METHOD(batch_del) {
 NAPI_METHOD(batch_merge) {
   NAPI_ARGV(4);
 
-  rocksdb::WriteBatch* batch;
+  Batch* batch;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&batch)));
 
   rocksdb::Slice key;
@@ -2098,9 +4510,119 @@ NAPI_METHOD(batch_merge) {
   NAPI_STATUS_THROWS(GetProperty(env, argv[3], "column", column));
 
   if (column) {
-    ROCKS_STATUS_THROWS_NAPI(batch->Merge(column, key, val));
+    ROCKS_STATUS_THROWS_NAPI(batch->base->Merge(column, key, val));
   } else {
-    ROCKS_STATUS_THROWS_NAPI(batch->Merge(key, val));
+    ROCKS_STATUS_THROWS_NAPI(batch->base->Merge(key, val));
+  }
+
+  return 0;
+}
+
+// The batch_append_packed stream holds, per operation, a BatchOp byte, a column
+// byte (0 for the default column, otherwise 1 + an index into `columns`), a
+// uint32 LE key length and the key and, for Put and Merge, a uint32 LE value
+// length and the value.
+static bool ReadPackedOp(std::span<const char> data,
+                         size_t& pos,
+                         BatchOp& op,
+                         uint8_t& column,
+                         rocksdb::Slice& key,
+                         rocksdb::Slice& val) {
+  const auto readSlice = [&](rocksdb::Slice& slice) {
+    if (data.size() - pos < 4) {
+      return false;
+    }
+    const auto bytes = reinterpret_cast<const uint8_t*>(data.data() + pos);
+    const uint32_t length = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    pos += 4;
+    if (data.size() - pos < length) {
+      return false;
+    }
+    slice = rocksdb::Slice(data.data() + pos, length);
+    pos += length;
+    return true;
+  };
+
+  if (data.size() - pos < 2) {
+    return false;
+  }
+
+  op = static_cast<BatchOp>(static_cast<uint8_t>(data[pos++]));
+  column = static_cast<uint8_t>(data[pos++]);
+
+  if (op != BatchOp::Put && op != BatchOp::Delete && op != BatchOp::Merge) {
+    return false;
+  }
+
+  if (!readSlice(key)) {
+    return false;
+  }
+
+  return op == BatchOp::Delete || readSlice(val);
+}
+
+NAPI_METHOD(batch_append_packed) {
+  NAPI_ARGV(3);
+
+  Batch* batch;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&batch)));
+
+  std::span<char> data;
+  NAPI_STATUS_THROWS(GetValue(env, argv[1], data));
+
+  std::vector<rocksdb::ColumnFamilyHandle*> columns;
+
+  bool hasColumns = false;
+  NAPI_STATUS_THROWS(napi_is_array(env, argv[2], &hasColumns));
+  if (hasColumns) {
+    uint32_t length;
+    NAPI_STATUS_THROWS(napi_get_array_length(env, argv[2], &length));
+
+    columns.resize(length);
+    for (uint32_t n = 0; n < length; n++) {
+      napi_value element;
+      NAPI_STATUS_THROWS(napi_get_element(env, argv[2], n, &element));
+      NAPI_STATUS_THROWS(GetValue(env, element, columns[n]));
+    }
+  }
+
+  BatchOp op;
+  uint8_t column;
+  rocksdb::Slice key;
+  rocksdb::Slice val;
+
+  // Validate the whole stream first so a malformed one leaves the batch as is.
+  for (size_t pos = 0; pos < data.size();) {
+    if (!ReadPackedOp(data, pos, op, column, key, val) || column > columns.size()) {
+      napi_throw_error(env, "LEVEL_INVALID_VALUE", "Invalid packed batch");
+      return nullptr;
+    }
+  }
+
+  for (size_t pos = 0; pos < data.size();) {
+    ReadPackedOp(data, pos, op, column, key, val);
+
+    auto handle = column ? columns[column - 1] : nullptr;
+    if (op == BatchOp::Put) {
+      ROCKS_STATUS_THROWS_NAPI(handle ? batch->base->Put(handle, key, val) : batch->base->Put(key, val));
+    } else if (op == BatchOp::Delete) {
+      ROCKS_STATUS_THROWS_NAPI(handle ? batch->base->Delete(handle, key) : batch->base->Delete(key));
+    } else {
+      ROCKS_STATUS_THROWS_NAPI(handle ? batch->base->Merge(handle, key, val) : batch->base->Merge(key, val));
+    }
+  }
+
+  return 0;
+}
+
+// Lets the packed batch encoder reject a bad `column` when the op is added,
+// rather than when the stream is appended.
+NAPI_METHOD(batch_check_column) {
+  NAPI_ARGV(1);
+
+  rocksdb::ColumnFamilyHandle* column;
+  if (GetValue(env, argv[0], column) != napi_ok) {
+    napi_throw_type_error(env, "LEVEL_INVALID_VALUE", "The 'column' option must be a column handle");
   }
 
   return 0;
@@ -2109,10 +4631,10 @@ NAPI_METHOD(batch_merge) {
 NAPI_METHOD(batch_clear) {
   NAPI_ARGV(1);
 
-  rocksdb::WriteBatch* batch;
+  Batch* batch;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&batch)));
 
-  batch->Clear();
+  batch->base->Clear();
 
   return 0;
 }
@@ -2123,7 +4645,7 @@ NAPI_METHOD(batch_write) {
   Database* database;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
 
-  rocksdb::WriteBatch* batch;
+  Batch* batch;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[1], reinterpret_cast<void**>(&batch)));
   bool sync = false;
   NAPI_STATUS_THROWS(GetProperty(env, argv[2], "sync", sync));
@@ -2140,7 +4662,7 @@ NAPI_METHOD(batch_write) {
     rocksdb::WriteOptions writeOptions;
     writeOptions.sync = sync;
     writeOptions.low_pri = lowPriority;
-    return database->db->Write(writeOptions, batch);
+    return database->db->Write(writeOptions, batch->Get());
   }));
 
   return 0;
@@ -2152,7 +4674,7 @@ NAPI_METHOD(batch_write_sync) {
   Database* database;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
 
-  rocksdb::WriteBatch* batch;
+  Batch* batch;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[1], reinterpret_cast<void**>(&batch)));
 
   bool sync = false;
@@ -2164,7 +4686,7 @@ NAPI_METHOD(batch_write_sync) {
   rocksdb::WriteOptions writeOptions;
   writeOptions.sync = sync;
   writeOptions.low_pri = lowPriority;
-  ROCKS_STATUS_THROWS_NAPI(database->db->Write(writeOptions, batch));
+  ROCKS_STATUS_THROWS_NAPI(database->db->Write(writeOptions, batch->Get()));
 
   return 0;
 }
@@ -2172,11 +4694,11 @@ NAPI_METHOD(batch_write_sync) {
 NAPI_METHOD(batch_count) {
   NAPI_ARGV(1);
 
-  rocksdb::WriteBatch* batch;
+  Batch* batch;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&batch)));
 
   napi_value result;
-  NAPI_STATUS_THROWS(napi_create_int64(env, batch->Count(), &result));
+  NAPI_STATUS_THROWS(napi_create_int64(env, batch->Get()->Count(), &result));
 
   return result;
 }
@@ -2187,7 +4709,7 @@ NAPI_METHOD(batch_iterate) {
   Database* database;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
 
-  rocksdb::WriteBatch* batch;
+  Batch* batch;
   NAPI_STATUS_THROWS(napi_get_value_external(env, argv[1], reinterpret_cast<void**>(&batch)));
 
   const auto options = argv[2];
@@ -2213,11 +4735,292 @@ NAPI_METHOD(batch_iterate) {
   BatchIterator iterator(nullptr, keys, values, data, column, keyEncoding, valueEncoding);
 
   napi_value result;
-  NAPI_STATUS_THROWS(iterator.Iterate(env, *batch, &result));
+  NAPI_STATUS_THROWS(iterator.Iterate(env, *batch->Get(), &result));
+
+  return result;
+}
+
+// Reads a key from an indexed batch, falling back to the DB for keys it does
+// not write. Pending merges are applied to the DB value.
+NAPI_METHOD(batch_get_sync) {
+  NAPI_ARGV(4);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  Batch* batch;
+  NAPI_STATUS_THROWS(GetValue(env, argv[1], batch));
+
+  rocksdb::PinnableSlice key;
+  NAPI_STATUS_THROWS(GetValue(env, argv[2], key));
+
+  const auto options = argv[3];
+
+  rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, options, "column", column));
+
+  Encoding valueEncoding = Encoding::Buffer;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "valueEncoding", valueEncoding));
+
+  rocksdb::ReadOptions readOptions;
+
+  readOptions.fill_cache = false;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "fillCache", readOptions.fill_cache));
+
+  readOptions.async_io = true;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "asyncIO", readOptions.async_io));
+
+  std::shared_ptr<const rocksdb::Snapshot> snapshot;
+  NAPI_STATUS_THROWS(GetSnapshot(env, options, readOptions, snapshot));
+
+  rocksdb::PinnableSlice value;
+  const auto status = batch->indexed->GetFromBatchAndDB(database->db.get(), readOptions, column, key, &value);
+
+  napi_value result;
+  if (status.IsNotFound()) {
+    NAPI_STATUS_THROWS(napi_get_undefined(env, &result));
+  } else {
+    ROCKS_STATUS_THROWS_NAPI(status);
+    NAPI_STATUS_THROWS(Convert(env, std::move(value), valueEncoding, result));
+  }
+
+  return result;
+}
+
+NAPI_METHOD(batch_get_many_sync) {
+  NAPI_ARGV(4);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  Batch* batch;
+  NAPI_STATUS_THROWS(GetValue(env, argv[1], batch));
+
+  std::string storage;
+  std::vector<rocksdb::Slice> keys;
+  NAPI_STATUS_THROWS(GetKeys(env, argv[2], false, storage, keys));
+
+  const auto options = argv[3];
+  const uint32_t count = keys.size();
+
+  rocksdb::ColumnFamilyHandle* column = database->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, options, "column", column));
+
+  Encoding valueEncoding = Encoding::Buffer;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "valueEncoding", valueEncoding));
+
+  rocksdb::ReadOptions readOptions;
+
+  readOptions.fill_cache = false;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "fillCache", readOptions.fill_cache));
+
+  readOptions.async_io = true;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "asyncIO", readOptions.async_io));
+
+  std::shared_ptr<const rocksdb::Snapshot> snapshot;
+  NAPI_STATUS_THROWS(GetSnapshot(env, options, readOptions, snapshot));
+
+  std::vector<rocksdb::Status> statuses(count);
+  std::vector<rocksdb::PinnableSlice> values(count);
+  batch->indexed->MultiGetFromBatchAndDB(database->db.get(), readOptions, column, count, keys.data(), values.data(),
+                                         statuses.data(), false);
+
+  napi_value rows;
+  NAPI_STATUS_THROWS(napi_create_array_with_length(env, count, &rows));
+
+  for (uint32_t n = 0; n < count; n++) {
+    napi_value row;
+    if (statuses[n].IsNotFound()) {
+      NAPI_STATUS_THROWS(napi_get_undefined(env, &row));
+    } else {
+      ROCKS_STATUS_THROWS_NAPI(statuses[n]);
+      NAPI_STATUS_THROWS(Convert(env, std::move(values[n]), valueEncoding, row));
+    }
+    NAPI_STATUS_THROWS(napi_set_element(env, rows, n, row));
+  }
+
+  return rows;
+}
+
+NAPI_METHOD(transaction_init) {
+  NAPI_ARGV(2);
+
+  Database* database;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&database)));
+
+  if (!database->db) {
+    napi_throw_error(env, "LEVEL_DATABASE_NOT_OPEN", "Database is not open");
+    return NULL;
+  }
+
+  if (!database->optimistic) {
+    napi_throw_error(env, "LEVEL_NOT_SUPPORTED", "Database was not opened with optimisticTransactions");
+    return NULL;
+  }
+
+  rocksdb::WriteOptions writeOptions;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[1], "sync", writeOptions.sync));
+
+  bool snapshot = false;
+  NAPI_STATUS_THROWS(GetProperty(env, argv[1], "snapshot", snapshot));
+
+  auto transaction = std::make_unique<Transaction>(database, writeOptions, snapshot);
+
+  napi_value result;
+  NAPI_STATUS_THROWS(
+      napi_create_external(env, transaction.get(), Finalize<Transaction>, transaction.get(), &result));
+  transaction.release();
+
+  return result;
+}
+
+// Reads through the transaction, so its own writes are visible. With
+// `forUpdate` the key is also tracked for conflicts at commit. Reads use the
+// transaction's snapshot, if it has one.
+NAPI_METHOD(transaction_get_sync) {
+  NAPI_ARGV(3);
+
+  Transaction* transaction;
+  NAPI_STATUS_THROWS(GetValue(env, argv[0], transaction));
+
+  rocksdb::PinnableSlice key;
+  NAPI_STATUS_THROWS(GetValue(env, argv[1], key));
+
+  const auto options = argv[2];
+
+  rocksdb::ColumnFamilyHandle* column = transaction->database_->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, options, "column", column));
+
+  Encoding valueEncoding = Encoding::Buffer;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "valueEncoding", valueEncoding));
+
+  bool forUpdate = false;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "forUpdate", forUpdate));
+
+  rocksdb::ReadOptions readOptions;
+  readOptions.snapshot = transaction->transaction_->GetSnapshot();
+
+  readOptions.fill_cache = false;
+  NAPI_STATUS_THROWS(GetProperty(env, options, "fillCache", readOptions.fill_cache));
+
+  rocksdb::PinnableSlice value;
+  const auto status = forUpdate
+                          ? transaction->transaction_->GetForUpdate(readOptions, column, key, &value)
+                          : transaction->transaction_->Get(readOptions, column, key, &value);
+
+  napi_value result;
+  if (status.IsNotFound()) {
+    NAPI_STATUS_THROWS(napi_get_undefined(env, &result));
+  } else {
+    ROCKS_STATUS_THROWS_NAPI(status);
+    NAPI_STATUS_THROWS(Convert(env, std::move(value), valueEncoding, result));
+  }
 
   return result;
 }
 
+NAPI_METHOD(transaction_put) {
+  NAPI_ARGV(4);
+
+  Transaction* transaction;
+  NAPI_STATUS_THROWS(GetValue(env, argv[0], transaction));
+
+  rocksdb::Slice key;
+  NAPI_STATUS_THROWS(GetValue(env, argv[1], key));
+
+  rocksdb::Slice val;
+  NAPI_STATUS_THROWS(GetValue(env, argv[2], val));
+
+  rocksdb::ColumnFamilyHandle* column = transaction->database_->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[3], "column", column));
+
+  ROCKS_STATUS_THROWS_NAPI(transaction->transaction_->Put(column, key, val));
+
+  return 0;
+}
+
+NAPI_METHOD(transaction_del) {
+  NAPI_ARGV(3);
+
+  Transaction* transaction;
+  NAPI_STATUS_THROWS(GetValue(env, argv[0], transaction));
+
+  rocksdb::Slice key;
+  NAPI_STATUS_THROWS(GetValue(env, argv[1], key));
+
+  rocksdb::ColumnFamilyHandle* column = transaction->database_->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[2], "column", column));
+
+  ROCKS_STATUS_THROWS_NAPI(transaction->transaction_->Delete(column, key));
+
+  return 0;
+}
+
+NAPI_METHOD(transaction_merge) {
+  NAPI_ARGV(4);
+
+  Transaction* transaction;
+  NAPI_STATUS_THROWS(GetValue(env, argv[0], transaction));
+
+  rocksdb::Slice key;
+  NAPI_STATUS_THROWS(GetValue(env, argv[1], key));
+
+  rocksdb::Slice val;
+  NAPI_STATUS_THROWS(GetValue(env, argv[2], val));
+
+  rocksdb::ColumnFamilyHandle* column = transaction->database_->db->DefaultColumnFamily();
+  NAPI_STATUS_THROWS(GetProperty(env, argv[3], "column", column));
+
+  ROCKS_STATUS_THROWS_NAPI(transaction->transaction_->Merge(column, key, val));
+
+  return 0;
+}
+
+// Validates tracked keys and writes the transaction. Fails with Busy on a
+// conflict, or TryAgain if the memtable history no longer covers the
+// transaction (see maxWriteBufferSizeToMaintain); either way nothing is
+// written and a new transaction may retry. The JS side holds off close()
+// and further operations until the callback runs.
+NAPI_METHOD(transaction_commit) {
+  NAPI_ARGV(2);
+
+  Transaction* transaction;
+  NAPI_STATUS_THROWS(GetValue(env, argv[0], transaction));
+
+  auto callback = argv[1];
+
+  napi_value resourceName;
+  NAPI_STATUS_THROWS(
+      transaction->database_->GetResourceName(env, ResourceLeveldownTransactionCommit, resourceName));
+
+  NAPI_STATUS_THROWS(
+      runAsync(resourceName, env, callback, [=](auto& state) { return transaction->transaction_->Commit(); }));
+
+  return 0;
+}
+
+NAPI_METHOD(transaction_rollback) {
+  NAPI_ARGV(1);
+
+  Transaction* transaction;
+  NAPI_STATUS_THROWS(GetValue(env, argv[0], transaction));
+
+  ROCKS_STATUS_THROWS_NAPI(transaction->transaction_->Rollback());
+
+  return 0;
+}
+
+NAPI_METHOD(transaction_close) {
+  NAPI_ARGV(1);
+
+  Transaction* transaction;
+  NAPI_STATUS_THROWS(napi_get_value_external(env, argv[0], reinterpret_cast<void**>(&transaction)));
+
+  ROCKS_STATUS_THROWS_NAPI(transaction->Close());
+
+  return 0;
+}
+
 struct Updates : public BatchIterator, public Closable {
   Updates(Database* database,
           const int64_t since,
@@ -2446,12 +5249,25 @@ NAPI_INIT() {
   NAPI_EXPORT_FUNCTION(db_get_handle);
   NAPI_EXPORT_FUNCTION(db_get_location);
   NAPI_EXPORT_FUNCTION(db_close);
+  NAPI_EXPORT_FUNCTION(db_get);
+  NAPI_EXPORT_FUNCTION(db_get_sync);
   NAPI_EXPORT_FUNCTION(db_get_many);
+  NAPI_EXPORT_FUNCTION(db_put_if_newer);
   NAPI_EXPORT_FUNCTION(db_get_many_sync);
+  NAPI_EXPORT_FUNCTION(db_get_nearest);
+  NAPI_EXPORT_FUNCTION(db_get_nearest_sync);
   NAPI_EXPORT_FUNCTION(db_clear);
   NAPI_EXPORT_FUNCTION(db_get_property);
   NAPI_EXPORT_FUNCTION(db_get_latest_sequence);
+  NAPI_EXPORT_FUNCTION(db_get_idle_iterators);
+  NAPI_EXPORT_FUNCTION(db_get_range_splits);
+  NAPI_EXPORT_FUNCTION(db_get_approximate_sizes);
+  NAPI_EXPORT_FUNCTION(db_get_approximate_counts);
   NAPI_EXPORT_FUNCTION(db_query);
+  NAPI_EXPORT_FUNCTION(db_query_many);
+  NAPI_EXPORT_FUNCTION(db_query_many_sync);
+  NAPI_EXPORT_FUNCTION(db_count);
+  NAPI_EXPORT_FUNCTION(db_count_sync);
   NAPI_EXPORT_FUNCTION(db_compact_range_sync);
   NAPI_EXPORT_FUNCTION(db_compact_range);
   NAPI_EXPORT_FUNCTION(db_flush_wal);
@@ -2462,6 +5278,7 @@ NAPI_INIT() {
   NAPI_EXPORT_FUNCTION(iterator_seek_sync);
   NAPI_EXPORT_FUNCTION(iterator_close_sync);
   NAPI_EXPORT_FUNCTION(iterator_nextv);
+  NAPI_EXPORT_FUNCTION(iterator_seek_nextv);
   NAPI_EXPORT_FUNCTION(iterator_nextv_sync);
 
   NAPI_EXPORT_FUNCTION(updates_init);
@@ -2471,6 +5288,8 @@ NAPI_INIT() {
   NAPI_EXPORT_FUNCTION(batch_init);
   NAPI_EXPORT_FUNCTION(batch_put);
   NAPI_EXPORT_FUNCTION(batch_put_log_data);
+  NAPI_EXPORT_FUNCTION(batch_append_packed);
+  NAPI_EXPORT_FUNCTION(batch_check_column);
   NAPI_EXPORT_FUNCTION(batch_del);
   NAPI_EXPORT_FUNCTION(batch_clear);
   NAPI_EXPORT_FUNCTION(batch_write);
@@ -2478,6 +5297,21 @@ NAPI_INIT() {
   NAPI_EXPORT_FUNCTION(batch_merge);
   NAPI_EXPORT_FUNCTION(batch_count);
   NAPI_EXPORT_FUNCTION(batch_iterate);
+  NAPI_EXPORT_FUNCTION(batch_get_sync);
+  NAPI_EXPORT_FUNCTION(batch_get_many_sync);
+
+  NAPI_EXPORT_FUNCTION(snapshot_init);
+  NAPI_EXPORT_FUNCTION(snapshot_get_sequence);
+  NAPI_EXPORT_FUNCTION(snapshot_close);
+
+  NAPI_EXPORT_FUNCTION(transaction_init);
+  NAPI_EXPORT_FUNCTION(transaction_get_sync);
+  NAPI_EXPORT_FUNCTION(transaction_put);
+  NAPI_EXPORT_FUNCTION(transaction_del);
+  NAPI_EXPORT_FUNCTION(transaction_merge);
+  NAPI_EXPORT_FUNCTION(transaction_commit);
+  NAPI_EXPORT_FUNCTION(transaction_rollback);
+  NAPI_EXPORT_FUNCTION(transaction_close);
 
   NAPI_EXPORT_FUNCTION(cache_init);
   NAPI_EXPORT_FUNCTION(cache_get_handle);
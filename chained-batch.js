@@ -6,20 +6,130 @@ const ModuleError = require('module-error')
 const assert = require('node:assert')
 
 const binding = require('./binding')
+const { snapshotOptions } = require('./snapshot')
 
 const kPromise = Symbol('promise')
 const kBatchContext = Symbol('batchContext')
 const kDbContext = Symbol('dbContext')
 const kBusy = Symbol('busy')
+const kEncoder = Symbol('encoder')
+const kIndexed = Symbol('indexed')
 
 const EMPTY = {}
+const EMPTY_BUFFER = Buffer.alloc(0)
+const INDEXED = Object.freeze({ indexed: true })
+
+// Opcodes match BatchOp in binding.cc.
+const OP_PUT = 1
+const OP_DEL = 2
+const OP_MERGE = 3
+
+// Encodes operations into the stream read by batch_append_packed so a whole
+// batch crosses into native code in one call instead of one call per op.
+class BatchEncoder {
+  constructor () {
+    // Allocated on the first op and grown as needed, as most batches made by
+    // db.put() and db.del() hold a single small op.
+    this.buffer = EMPTY_BUFFER
+    this.length = 0
+    this.columns = []
+  }
+
+  put (key, value, column) {
+    this._append(OP_PUT, key, value, column)
+  }
+
+  del (key, column) {
+    this._append(OP_DEL, key, null, column)
+  }
+
+  merge (key, value, column) {
+    this._append(OP_MERGE, key, value, column)
+  }
+
+  // Appends everything encoded so far to the native batch and resets, also
+  // if that fails (leaving the native batch as it was).
+  flush (batch) {
+    if (this.length > 0) {
+      try {
+        binding.batch_append_packed(batch, this.buffer.subarray(0, this.length), this.columns)
+      } finally {
+        this.reset()
+      }
+    }
+  }
+
+  reset () {
+    this.length = 0
+    this.columns = []
+  }
+
+  _append (op, key, value, column) {
+    const index = this._column(column)
+    const keyLength = byteLength(key)
+    const valueLength = value === null ? 0 : byteLength(value)
+    this._reserve(2 + 4 + keyLength + (value === null ? 0 : 4 + valueLength))
+
+    const buffer = this.buffer
+    buffer[this.length++] = op
+    buffer[this.length++] = index
+    this.length = buffer.writeUInt32LE(keyLength, this.length)
+    this.length += write(buffer, key, this.length)
+    if (value !== null) {
+      this.length = buffer.writeUInt32LE(valueLength, this.length)
+      this.length += write(buffer, value, this.length)
+    }
+  }
+
+  _column (column) {
+    if (column == null) {
+      return 0
+    }
+
+    let index = this.columns.indexOf(column)
+    if (index === -1) {
+      binding.batch_check_column(column)
+      index = this.columns.push(column) - 1
+    }
+
+    // The column is a single byte in the stream, 0 being the default column.
+    assert(index < 255, 'Too many columns in one packed batch')
+
+    return index + 1
+  }
+
+  _reserve (size) {
+    if (this.length + size > this.buffer.length) {
+      const buffer = Buffer.allocUnsafe(Math.max(this.buffer.length * 2, this.length + size, 64))
+      this.buffer.copy(buffer, 0, 0, this.length)
+      this.buffer = buffer
+    }
+  }
+}
+
+function byteLength (data) {
+  return typeof data === 'string' ? Buffer.byteLength(data) : data.byteLength
+}
+
+function write (buffer, data, offset) {
+  if (typeof data === 'string') {
+    return buffer.write(data, offset)
+  }
+
+  buffer.set(data, offset)
+  return data.byteLength
+}
 
 class ChainedBatch extends AbstractChainedBatch {
-  constructor (db, context) {
+  // With `indexed`, pending writes are indexed so that get(), getMany() and
+  // iterator() can read them merged with the db.
+  constructor (db, context, options) {
     super(db)
 
     this[kDbContext] = context
-    this[kBatchContext] = binding.batch_init()
+    this[kIndexed] = options?.indexed === true
+    this[kBatchContext] = binding.batch_init(context, this[kIndexed] ? INDEXED : EMPTY)
+    this[kEncoder] = new BatchEncoder()
     this[kBusy] = false
   }
 
@@ -30,6 +140,7 @@ class ChainedBatch extends AbstractChainedBatch {
   get length () {
     assert(this[kBatchContext])
 
+    this[kEncoder].flush(this[kBatchContext])
     return binding.batch_count(this[kBatchContext])
   }
 
@@ -49,10 +160,7 @@ class ChainedBatch extends AbstractChainedBatch {
       })
     }
 
-    key = typeof key === 'string' ? Buffer.from(key) : key
-    value = typeof value === 'string' ? Buffer.from(value) : value
-
-    binding.batch_put(this[kBatchContext], key, value, options ?? EMPTY)
+    this[kEncoder].put(key, value, options?.column)
   }
 
   _putLogData (blob) {
@@ -67,6 +175,7 @@ class ChainedBatch extends AbstractChainedBatch {
 
     blob = typeof blob === 'string' ? Buffer.from(blob) : blob
 
+    this[kEncoder].flush(this[kBatchContext])
     binding.batch_put_log_data(this[kBatchContext], blob)
   }
 
@@ -80,16 +189,20 @@ class ChainedBatch extends AbstractChainedBatch {
       })
     }
 
-    key = typeof key === 'string' ? Buffer.from(key) : key
-
-    binding.batch_del(this[kBatchContext], key, options ?? EMPTY)
+    this[kEncoder].del(key, options?.column)
   }
 
   _clear () {
     assert(this[kBatchContext])
     assert(!this[kBusy])
 
-    binding.batch_clear(this[kBatchContext])
+    this[kEncoder].reset()
+    if (this[kIndexed]) {
+      // Open iterators keep reading the old batch.
+      this[kBatchContext] = binding.batch_init(this[kDbContext], INDEXED)
+    } else {
+      binding.batch_clear(this[kBatchContext])
+    }
   }
 
   _write (options, callback) {
@@ -103,6 +216,7 @@ class ChainedBatch extends AbstractChainedBatch {
     assert(this[kBatchContext])
     assert(!this[kBusy])
 
+    this[kEncoder].flush(this[kBatchContext])
     binding.batch_write_sync(this[kDbContext], this[kBatchContext], options ?? EMPTY)
   }
 
@@ -114,6 +228,7 @@ class ChainedBatch extends AbstractChainedBatch {
 
     this[kBusy] = true
     try {
+      this[kEncoder].flush(this[kBatchContext])
       binding.batch_write(this[kDbContext], this[kBatchContext], options ?? EMPTY, (err) => {
         this[kBusy] = false
         callback(err)
@@ -142,7 +257,11 @@ class ChainedBatch extends AbstractChainedBatch {
     assert(this[kBatchContext])
     assert(!this[kBusy])
 
-    binding.batch_clear(this[kBatchContext])
+    this[kEncoder].reset()
+    if (!this[kIndexed]) {
+      // An indexed batch is freed once its iterators are too.
+      binding.batch_clear(this[kBatchContext])
+    }
     this[kBatchContext] = null
   }
 
@@ -162,10 +281,68 @@ class ChainedBatch extends AbstractChainedBatch {
       })
     }
 
-    key = typeof key === 'string' ? Buffer.from(key) : key
-    value = typeof value === 'string' ? Buffer.from(value) : value
+    this[kEncoder].merge(key, value, options?.column)
+  }
+
+  // Reads `key` as if this batch had been written, or undefined if it does not
+  // exist. Requires an indexed batch.
+  get (key, options, callback) {
+    callback = fromCallback(callback, kPromise)
+
+    try {
+      process.nextTick(callback, null, this.getSync(key, options))
+    } catch (err) {
+      process.nextTick(callback, err)
+    }
+
+    return callback[kPromise]
+  }
+
+  getSync (key, options) {
+    this._flushIndexed()
+    return binding.batch_get_sync(this[kDbContext], this[kBatchContext], key, this._readOptions(options))
+  }
+
+  getMany (keys, options, callback) {
+    callback = fromCallback(callback, kPromise)
+
+    try {
+      process.nextTick(callback, null, this.getManySync(keys, options))
+    } catch (err) {
+      process.nextTick(callback, err)
+    }
+
+    return callback[kPromise]
+  }
+
+  getManySync (keys, options) {
+    this._flushIndexed()
+    return binding.batch_get_many_sync(this[kDbContext], this[kBatchContext], keys, this._readOptions(options))
+  }
+
+  // An iterator over the db with the writes of this batch merged in. It reads
+  // on the calling thread, as the batch may be written to meanwhile. Requires
+  // an indexed batch.
+  iterator (options) {
+    this._flushIndexed()
+    return this.db.iterator({ ...options, batch: this[kBatchContext] })
+  }
+
+  _flushIndexed () {
+    assert(this[kBatchContext])
+    assert(!this[kBusy])
+
+    if (!this[kIndexed]) {
+      throw new ModuleError('Batch is not indexed', {
+        code: 'LEVEL_NOT_SUPPORTED'
+      })
+    }
+
+    this[kEncoder].flush(this[kBatchContext])
+  }
 
-    binding.batch_merge(this[kBatchContext], key, value, options ?? EMPTY)
+  _readOptions (options) {
+    return snapshotOptions(this.db, options) ?? EMPTY
   }
 
   * [Symbol.iterator] () {
@@ -184,6 +361,7 @@ class ChainedBatch extends AbstractChainedBatch {
       return []
     }
 
+    this[kEncoder].flush(this[kBatchContext])
     return binding.batch_iterate(this[kDbContext], this[kBatchContext], {
       keys: true,
       values: true,
@@ -194,3 +372,4 @@ class ChainedBatch extends AbstractChainedBatch {
 }
 
 exports.ChainedBatch = ChainedBatch
+exports.BatchEncoder = BatchEncoder
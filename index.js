@@ -4,9 +4,12 @@ const { fromCallback } = require('catering')
 const { AbstractLevel } = require('abstract-level')
 const ModuleError = require('module-error')
 const binding = require('./binding')
-const { ChainedBatch } = require('./chained-batch')
+const { ChainedBatch, BatchEncoder } = require('./chained-batch')
 const { RocksCache } = require('./cache')
 const { Iterator } = require('./iterator')
+const { PackedRows, PackedValues } = require('./packed')
+const { Snapshot, snapshotOptions } = require('./snapshot')
+const { Transaction } = require('./transaction')
 const fs = require('node:fs')
 const assert = require('node:assert')
 
@@ -15,6 +18,8 @@ const kColumns = Symbol('columns')
 const kPromise = Symbol('promise')
 const kRefs = Symbol('refs')
 const kPendingClose = Symbol('pendingClose')
+const kGetQueues = Symbol('getQueues')
+const kWriteQueues = Symbol('writeQueues')
 
 const { kRef, kUnref } = require('./util')
 
@@ -30,7 +35,15 @@ class RocksLevel extends AbstractLevel {
       seek: true,
       additionalMethods: {
         updates: true,
-        query: true
+        query: true,
+        count: true,
+        queryMany: true,
+        getFloor: true,
+        getCeiling: true,
+        snapshot: true,
+        indexedBatch: true,
+        transaction: true,
+        putIfNewer: true
       }
     }, options)
 
@@ -39,6 +52,14 @@ class RocksLevel extends AbstractLevel {
 
     this[kRefs] = 0
     this[kPendingClose] = null
+
+    // Opt-in: gets issued in the same tick are coalesced into one MultiGet per
+    // column and read options.
+    this[kGetQueues] = options.coalesceGets ? new Map() : null
+
+    // Opt-in: puts and dels issued in the same tick are appended to one
+    // WriteBatch per write options and committed with a single write.
+    this[kWriteQueues] = options.coalesceWrites ? new Map() : null
   }
 
   [Symbol.asyncDispose] () {
@@ -61,6 +82,11 @@ class RocksLevel extends AbstractLevel {
     return binding.db_get_latest_sequence(this[kContext])
   }
 
+  // Undocumented, exposed for tests only
+  get idleIterators () {
+    return binding.db_get_idle_iterators(this[kContext])
+  }
+
   get columns () {
     return this[kColumns]
   }
@@ -140,6 +166,13 @@ class RocksLevel extends AbstractLevel {
   _put (key, value, options, callback) {
     callback = fromCallback(callback, kPromise)
 
+    if (this[kWriteQueues]) {
+      key = typeof key === 'string' ? Buffer.from(key) : key
+      value = typeof value === 'string' ? Buffer.from(value) : value
+      this._writeCoalesced((batch) => binding.batch_put(batch, key, value, options ?? kEmpty), options ?? kEmpty, callback)
+      return callback[kPromise]
+    }
+
     try {
       const batch = this.batch()
       batch.put(key, value, options ?? kEmpty)
@@ -154,40 +187,112 @@ class RocksLevel extends AbstractLevel {
   _get (key, options, callback) {
     callback = fromCallback(callback, kPromise)
 
-    this._getMany([key], options ?? kEmpty, (err, val) => {
-      if (err) {
-        callback(err)
-      } else if (val[0] === undefined) {
-        callback(Object.assign(new Error('not found'), {
-          code: 'LEVEL_NOT_FOUND'
-        }))
-      } else {
-        callback(null, val[0])
-      }
-    })
+    // A deadline or byte limit shared by a whole MultiGet would apply to other
+    // gets too, so those are not coalesced.
+    if (this[kGetQueues] && !options?.snapshot && options?.timeout == null && options?.highWaterMarkBytes == null) {
+      this._getCoalesced(key, options ?? kEmpty, callback)
+      return callback[kPromise]
+    }
+
+    try {
+      this[kRef]()
+      binding.db_get(this[kContext], key, snapshotOptions(this, options) ?? kEmpty, (err, val) => {
+        this[kUnref]()
+        if (err) {
+          callback(err)
+        } else if (val === undefined) {
+          callback(Object.assign(new Error('not found'), {
+            code: 'LEVEL_NOT_FOUND'
+          }))
+        } else {
+          callback(null, val)
+        }
+      })
+    } catch (err) {
+      this[kUnref]()
+      process.nextTick(callback, err)
+    }
 
     return callback[kPromise]
   }
 
+  _getCoalesced (key, options, callback) {
+    const { column = null, fillCache = false, asyncIO = true, valueEncoding, unsafe = false } = options
+    const signature = `${fillCache}:${asyncIO}:${valueEncoding}:${unsafe}`
+
+    let queues = this[kGetQueues].get(column)
+    if (!queues) {
+      queues = new Map()
+      this[kGetQueues].set(column, queues)
+    }
+
+    let queue = queues.get(signature)
+    if (!queue) {
+      queue = { keys: [], callbacks: [] }
+      queues.set(signature, queue)
+
+      // Taken now rather than on flush so a close() in this tick waits for it.
+      this[kRef]()
+      process.nextTick(() => {
+        queues.delete(signature)
+        if (queues.size === 0) {
+          this[kGetQueues].delete(column)
+        }
+
+        const { keys, callbacks } = queue
+        const options = { column, fillCache, asyncIO, valueEncoding, unsafe }
+
+        try {
+          binding.db_get_many(this[kContext], keys, options, (err, values) => {
+            this[kUnref]()
+            for (let n = 0; n < callbacks.length; n++) {
+              if (err) {
+                callbacks[n](err)
+              } else if (values[n] === undefined) {
+                callbacks[n](Object.assign(new Error('not found'), {
+                  code: 'LEVEL_NOT_FOUND'
+                }))
+              } else {
+                callbacks[n](null, values[n])
+              }
+            }
+          })
+        } catch (err) {
+          this[kUnref]()
+          for (const callback of callbacks) {
+            callback(err)
+          }
+        }
+      })
+    }
+
+    queue.keys.push(key)
+    queue.callbacks.push(callback)
+  }
+
+  // Resolves to undefined rather than throwing if the key is not found.
+  _getSync (key, options) {
+    return binding.db_get_sync(this[kContext], key, snapshotOptions(this, options) ?? kEmpty)
+  }
+
   _getMany (keys, options, callback) {
     return this._getManyAsync(keys, options, callback)
   }
 
+  // `keys` is an array of strings and/or buffers (strings are encoded
+  // natively), or a packed `{ buffer, offsets }` / `{ string, offsets }` where
+  // key n spans [offsets[n], offsets[n + 1]) of the buffer or string.
   _getManyAsync (keys, options, callback) {
-    if (keys.some(key => typeof key === 'string')) {
-      keys = keys.map(key => typeof key === 'string' ? Buffer.from(key) : key)
-    }
-
     callback = fromCallback(callback, kPromise)
 
     try {
       this[kRef]()
-      binding.db_get_many(this[kContext], keys, options ?? kEmpty, (err, val) => {
+      binding.db_get_many(this[kContext], keys, snapshotOptions(this, options) ?? kEmpty, (err, val) => {
         this[kUnref]()
         if (err) {
           callback(err)
         } else {
-          callback(null, val)
+          callback(null, unpackValues(val, keyCount(keys), options))
         }
       })
     } catch (err) {
@@ -199,16 +304,114 @@ class RocksLevel extends AbstractLevel {
   }
 
   _getManySync (keys, options) {
-    if (keys.some(key => typeof key === 'string')) {
-      keys = keys.map(key => typeof key === 'string' ? Buffer.from(key) : key)
+    const values = binding.db_get_many_sync(this[kContext], keys, snapshotOptions(this, options) ?? kEmpty)
+    return unpackValues(values, keyCount(keys), options)
+  }
+
+  // Stores `value` behind a length-prefixed `rev` header unless the stored
+  // revision is the same or newer (by compareRev, as the maxRev merge operator
+  // orders them). Checked and written atomically with respect to other
+  // putIfNewer() calls, not to plain writes. Resolves to whether it wrote.
+  putIfNewer (key, rev, value, options, callback) {
+    callback = fromCallback(callback, kPromise)
+
+    if (this.status !== 'open') {
+      process.nextTick(callback, new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      }))
+      return callback[kPromise]
+    }
+
+    this[kRef]()
+    try {
+      binding.db_put_if_newer(this[kContext], key, rev, value, options ?? kEmpty, (err, written) => {
+        this[kUnref]()
+        callback(err, written)
+      })
+    } catch (err) {
+      this[kUnref]()
+      process.nextTick(callback, err)
+    }
+
+    return callback[kPromise]
+  }
+
+  // The last entry at or before `key`, as [key, value], or undefined.
+  getFloor (key, options, callback) {
+    return this._getNearest([key], true, false, options, callback)
+  }
+
+  // The first entry at or after `key`, as [key, value], or undefined.
+  getCeiling (key, options, callback) {
+    return this._getNearest([key], false, false, options, callback)
+  }
+
+  getFloorMany (keys, options, callback) {
+    return this._getNearest(keys, true, true, options, callback)
+  }
+
+  getCeilingMany (keys, options, callback) {
+    return this._getNearest(keys, false, true, options, callback)
+  }
+
+  getFloorSync (key, options) {
+    return this._getNearestSync([key], true, options)[0]
+  }
+
+  getCeilingSync (key, options) {
+    return this._getNearestSync([key], false, options)[0]
+  }
+
+  _getNearest (keys, reverse, many, options, callback) {
+    callback = fromCallback(callback, kPromise)
+
+    if (this.status !== 'open') {
+      process.nextTick(callback, new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      }))
+      return callback[kPromise]
+    }
+
+    this[kRef]()
+    try {
+      options = { ...snapshotOptions(this, options), reverse }
+      binding.db_get_nearest(this[kContext], keys, options, (err, rows) => {
+        this[kUnref]()
+        if (err) {
+          callback(err)
+        } else {
+          const entries = toEntries(rows)
+          callback(null, many ? entries : entries[0])
+        }
+      })
+    } catch (err) {
+      this[kUnref]()
+      process.nextTick(callback, err)
+    }
+
+    return callback[kPromise]
+  }
+
+  _getNearestSync (keys, reverse, options) {
+    if (this.status !== 'open') {
+      throw new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      })
     }
 
-    return binding.db_get_many_sync(this[kContext], keys, options ?? kEmpty)
+    options = { ...snapshotOptions(this, options), reverse }
+    return toEntries(binding.db_get_nearest_sync(this[kContext], keys, options))
   }
 
   _del (key, options, callback) {
     callback = fromCallback(callback, kPromise)
 
+    if (this[kWriteQueues]) {
+      key = typeof key === 'string' ? Buffer.from(key) : key
+      this._writeCoalesced((batch) => binding.batch_del(batch, key, options ?? kEmpty), options ?? kEmpty, callback)
+      return callback[kPromise]
+    }
+
     try {
       const batch = this.batch()
       batch.del(key, options ?? kEmpty)
@@ -220,6 +423,53 @@ class RocksLevel extends AbstractLevel {
     return callback[kPromise]
   }
 
+  // Appends a single operation to the pending batch for its write options. An
+  // invalid operation fails only its own caller; the rest share the outcome of
+  // the one batch_write.
+  _writeCoalesced (append, options, callback) {
+    const { sync = false, lowPriority = false } = options
+    const signature = `${sync}:${lowPriority}`
+
+    let queue = this[kWriteQueues].get(signature)
+    if (!queue) {
+      queue = { batch: binding.batch_init(), callbacks: [] }
+      this[kWriteQueues].set(signature, queue)
+
+      // Taken now rather than on flush so a close() in this tick waits for it.
+      this[kRef]()
+      process.nextTick(() => {
+        this[kWriteQueues].delete(signature)
+
+        const { batch, callbacks } = queue
+        const done = (err) => {
+          this[kUnref]()
+          binding.batch_clear(batch)
+          for (const callback of callbacks) {
+            callback(err)
+          }
+        }
+
+        if (callbacks.length === 0) {
+          done(null)
+          return
+        }
+
+        try {
+          binding.batch_write(this[kContext], batch, { sync, lowPriority }, done)
+        } catch (err) {
+          done(err)
+        }
+      })
+    }
+
+    try {
+      append(queue.batch)
+      queue.callbacks.push(callback)
+    } catch (err) {
+      process.nextTick(callback, err)
+    }
+  }
+
   _clear (options, callback) {
     callback = fromCallback(callback, kPromise)
 
@@ -242,22 +492,39 @@ class RocksLevel extends AbstractLevel {
     return new ChainedBatch(this, this[kContext])
   }
 
+  // A chained batch that can be read from (get, getMany, iterator) with its
+  // pending writes merged over the db.
+  indexedBatch () {
+    if (this.status !== 'open') {
+      throw new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      })
+    }
+
+    return new ChainedBatch(this, this[kContext], { indexed: true })
+  }
+
   _batch (operations, options, callback) {
     callback = fromCallback(callback, kPromise)
 
     const batch = binding.batch_init()
+    const encoder = new BatchEncoder()
 
-    for (let { type, key, value, ...rest } of operations) {
-      if (type === 'del') {
-        key = typeof key === 'string' ? Buffer.from(key) : key
-        binding.batch_del(batch, key, rest)
-      } else if (type === 'put') {
-        key = typeof key === 'string' ? Buffer.from(key) : key
-        value = typeof value === 'string' ? Buffer.from(value) : value
-        binding.batch_put(batch, key, value, rest)
-      } else {
-        assert(false)
+    try {
+      for (const { type, key, value, column } of operations) {
+        if (type === 'del') {
+          encoder.del(key, column)
+        } else if (type === 'put') {
+          encoder.put(key, value, column)
+        } else {
+          assert(false)
+        }
       }
+      encoder.flush(batch)
+    } catch (err) {
+      binding.batch_clear(batch)
+      process.nextTick(callback, err)
+      return callback[kPromise]
     }
 
     // Hold a db ref for the duration of the write so close() defers db_close
@@ -281,7 +548,31 @@ class RocksLevel extends AbstractLevel {
   }
 
   _iterator (options) {
-    return new Iterator(this, this[kContext], options ?? kEmpty)
+    return new Iterator(this, this[kContext], snapshotOptions(this, options) ?? kEmpty)
+  }
+
+  // A consistent read view to pass as the `snapshot` option of get, getMany,
+  // iterator, query and count. Call close() on it when done.
+  snapshot () {
+    if (this.status !== 'open') {
+      throw new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      })
+    }
+
+    return new Snapshot(this, this[kContext])
+  }
+
+  // An optimistic transaction; requires the `optimisticTransactions` open
+  // option. With `snapshot: true` its reads see the db as of its creation.
+  transaction (options) {
+    if (this.status !== 'open') {
+      throw new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      })
+    }
+
+    return new Transaction(this, this[kContext], options)
   }
 
   get identity () {
@@ -294,6 +585,32 @@ class RocksLevel extends AbstractLevel {
     return binding.db_get_identity(this[kContext])
   }
 
+  // Estimated on-disk (and memtable) bytes of a { gte, lt } range, or of each
+  // range in an array of them.
+  approximateSize (ranges, options) {
+    if (this.status !== 'open') {
+      throw new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      })
+    }
+
+    const sizes = binding.db_get_approximate_sizes(this[kContext], [ranges].flat(), options ?? kEmpty)
+    return Array.isArray(ranges) ? sizes : sizes[0]
+  }
+
+  // Estimated number of entries of a { gte, lt } range, or of each range in an
+  // array of them.
+  approximateCount (ranges, options) {
+    if (this.status !== 'open') {
+      throw new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      })
+    }
+
+    const counts = binding.db_get_approximate_counts(this[kContext], [ranges].flat(), options ?? kEmpty)
+    return Array.isArray(ranges) ? counts : counts[0]
+  }
+
   getProperty (property) {
     if (typeof property !== 'string') {
       throw new TypeError("The first argument 'property' must be a string")
@@ -328,7 +645,52 @@ class RocksLevel extends AbstractLevel {
       })
     }
 
-    return binding.db_query(this[kContext], options ?? kEmpty)
+    const result = binding.db_query(this[kContext], snapshotOptions(this, options) ?? kEmpty)
+    if (options?.format === 'packed') {
+      result.rows = new PackedRows(result, options)
+    }
+    return result
+  }
+
+  // Reads several { gt, gte, lt, lte, limit, reverse } ranges in one native
+  // call, sharing one rocksdb iterator. Resolves to the rows of each range.
+  queryMany (ranges, options, callback) {
+    callback = fromCallback(callback, kPromise)
+
+    if (this.status !== 'open') {
+      process.nextTick(callback, new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      }))
+      return callback[kPromise]
+    }
+
+    this[kRef]()
+    try {
+      binding.db_query_many(this[kContext], ranges, snapshotOptions(this, options) ?? kEmpty, (err, val) => {
+        this[kUnref]()
+        if (err) {
+          callback(err)
+        } else {
+          callback(null, unpackRanges(val, options))
+        }
+      })
+    } catch (err) {
+      this[kUnref]()
+      process.nextTick(callback, err)
+    }
+
+    return callback[kPromise]
+  }
+
+  queryManySync (ranges, options) {
+    if (this.status !== 'open') {
+      throw new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      })
+    }
+
+    const result = binding.db_query_many_sync(this[kContext], ranges, snapshotOptions(this, options) ?? kEmpty)
+    return unpackRanges(result, options)
   }
 
   async * updates (options) {
@@ -365,6 +727,121 @@ class RocksLevel extends AbstractLevel {
     }
   }
 
+  // Counts the entries in a range, honouring the iterator filters and limit,
+  // without materializing them. Resolves to { count, keyBytes, valueBytes }.
+  count (options, callback) {
+    callback = fromCallback(callback, kPromise)
+
+    if (this.status !== 'open') {
+      process.nextTick(callback, new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      }))
+      return callback[kPromise]
+    }
+
+    this[kRef]()
+    try {
+      binding.db_count(this[kContext], snapshotOptions(this, options) ?? kEmpty, (err, val) => {
+        this[kUnref]()
+        callback(err, val)
+      })
+    } catch (err) {
+      this[kUnref]()
+      process.nextTick(callback, err)
+    }
+
+    return callback[kPromise]
+  }
+
+  countSync (options) {
+    if (this.status !== 'open') {
+      throw new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      })
+    }
+
+    return binding.db_count_sync(this[kContext], snapshotOptions(this, options) ?? kEmpty)
+  }
+
+  // Scans a range with up to `concurrency` iterators over sub-ranges split at
+  // SST file boundaries, so that each reads on its own threadpool worker.
+  // Yields batches of [key, value] entries, in key order unless `ordered` is
+  // false, in which case batches are yielded as soon as any shard has one.
+  async * parallelScan ({ concurrency = 4, ordered = true, batchSize = 1000, limit = -1, ...options } = {}) {
+    if (this.status !== 'open') {
+      throw new ModuleError('Database is not open', {
+        code: 'LEVEL_DATABASE_NOT_OPEN'
+      })
+    }
+
+    if (options.reverse) {
+      throw new ModuleError('parallelScan() does not support reverse', {
+        code: 'LEVEL_NOT_SUPPORTED'
+      })
+    }
+
+    const { gt, gte, lt, lte, ...rest } = options
+    const splits = this._rangeSplits(concurrency, options)
+
+    const iterators = []
+    for (let n = 0; n <= splits.length; n++) {
+      iterators.push(this.iterator({
+        ...rest,
+        ...(n === 0 ? { gt, gte } : { gte: splits[n - 1] }),
+        ...(n === splits.length ? { lt, lte } : { lt: splits[n] }),
+        prefetch: true
+      }))
+    }
+
+    const pending = iterators.map((iterator, n) => iterator.nextv(batchSize).then((entries) => [n, entries]))
+    pending.forEach((promise) => promise.catch(() => {}))
+
+    try {
+      let shard = 0
+      let remaining = iterators.length
+      while (remaining > 0 && limit !== 0) {
+        const [n, entries] = ordered ? await pending[shard] : await Promise.race(pending.filter(Boolean))
+
+        if (entries.length === 0) {
+          pending[n] = null
+          remaining--
+          shard++
+          continue
+        }
+
+        pending[n] = iterators[n].nextv(batchSize).then((entries) => [n, entries])
+        pending[n].catch(() => {})
+
+        if (limit > 0 && entries.length >= limit) {
+          entries.length = limit
+        }
+        if (limit > 0) {
+          limit -= entries.length
+        }
+
+        yield entries
+      }
+    } finally {
+      await Promise.allSettled(iterators.map((iterator) => iterator.close()))
+    }
+  }
+
+  // Up to `count - 1` keys that split the range into shards of about equal
+  // size on disk, at SST file boundaries. Undocumented, used by parallelScan().
+  _rangeSplits (count, options) {
+    const keyEncoding = this.keyEncoding(options.keyEncoding)
+    const { gt, gte, lt, lte } = options
+
+    // Splits are computed in encoded form and decoded into bounds for the shards.
+    return binding.db_get_range_splits(this[kContext], {
+      column: options.column,
+      gte: gte !== undefined ? keyEncoding.encode(gte) : gt !== undefined ? keyEncoding.encode(gt) : undefined,
+      lt: lt !== undefined ? keyEncoding.encode(lt) : lte !== undefined ? keyEncoding.encode(lte) : undefined,
+      count,
+      keyEncoding: keyEncoding.format === 'utf8' ? 'utf8' : 'buffer'
+    }).map((key) => keyEncoding.decode(key))
+  }
+
   compactRange (options = {}, callback) {
     callback = fromCallback(callback, kPromise)
 
@@ -412,5 +889,45 @@ class RocksLevel extends AbstractLevel {
   }
 }
 
+// format: 'packed' resolves to a lazy PackedValues view, or to the number of
+// value bytes when the caller supplied its own `buffer` and `offsets` (if that
+// exceeds buffer.byteLength nothing was copied and the read must be retried
+// with a bigger buffer).
+function unpackValues (result, count, options) {
+  return options?.format === 'packed' && typeof result === 'object'
+    ? new PackedValues(result, count, options)
+    : result
+}
+
+// [key, value] entries from flat rows, undefined where both are.
+function toEntries (rows) {
+  const entries = []
+  for (let n = 0; n < rows.length; n += 2) {
+    entries.push(rows[n] === undefined ? undefined : [rows[n], rows[n + 1]])
+  }
+  return entries
+}
+
+// Splits a packed queryMany result into a PackedRows per range.
+function unpackRanges (result, options) {
+  if (options?.format !== 'packed') {
+    return result
+  }
+
+  const { buffer, offsets, ranges } = result
+  const rows = []
+  for (let n = 0; n + 1 < ranges.length; n++) {
+    rows.push(new PackedRows({ buffer, offsets: offsets.subarray(ranges[n] * 2, ranges[n + 1] * 2 + 1) }, options))
+  }
+  return rows
+}
+
+function keyCount (keys) {
+  return Array.isArray(keys) ? keys.length : keys.offsets.length - 1
+}
+
 exports.RocksLevel = RocksLevel
+exports.PackedValues = PackedValues
 exports.RocksCache = RocksCache
+exports.Snapshot = Snapshot
+exports.Transaction = Transaction
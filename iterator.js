@@ -2,8 +2,10 @@
 
 const { fromCallback } = require('catering')
 const { AbstractIterator } = require('abstract-level')
+const ModuleError = require('module-error')
 const assert = require('node:assert')
 const { kRef, kUnref } = require('./util')
+const { PackedRows } = require('./packed')
 
 const binding = require('./binding')
 
@@ -16,6 +18,11 @@ const kFirst = Symbol('first')
 const kPosition = Symbol('position')
 const kBusy = Symbol('busy')
 const kPendingClose = Symbol('pendingClose')
+const kPacked = Symbol('packed')
+const kReadAhead = Symbol('readAhead')
+const kPrefetch = Symbol('prefetch')
+const kSeek = Symbol('seek')
+const kBatch = Symbol('batch')
 
 const kEmpty = Object.freeze([])
 
@@ -32,6 +39,21 @@ class Iterator extends AbstractIterator {
     this[kDB] = db
     this[kBusy] = false
     this[kPendingClose] = null
+    this[kPacked] = options.format === 'packed' ? options : null
+
+    // With `prefetch`, the next batch is read on the threadpool while JS is
+    // still consuming the current one. Each batch is bounded by
+    // highWaterMarkBytes, so at most two are held at a time.
+    this[kReadAhead] = options.prefetch === true && options.batch == null
+    this[kPrefetch] = null
+
+    // An indexed batch read through (see ChainedBatch#iterator). Reads then
+    // stay on this thread, as JS may append to the batch at any time.
+    this[kBatch] = options.batch ?? null
+
+    // A seek() target not yet applied to the native iterator. It is sent along
+    // with the next async read (iterator_seek_nextv), saving a threadpool hop.
+    this[kSeek] = null
   }
 
   [Symbol.asyncDispose] () {
@@ -39,7 +61,34 @@ class Iterator extends AbstractIterator {
   }
 
   _seek (target) {
-    this._seekSync(target)
+    assert(this[kContext])
+    assert(!this[kBusy] || this[kPrefetch])
+
+    const prefetch = this[kPrefetch]
+    if (prefetch && !prefetch.settled) {
+      this._seekSync(target)
+      return
+    }
+
+    if (target.length === 0) {
+      throw new Error('cannot seek() to an empty target')
+    }
+
+    this[kFirst] = true
+    this[kCache] = kEmpty
+    this[kFinished] = false
+    this[kPosition] = 0
+    this[kPrefetch] = null
+    this[kSeek] = target
+  }
+
+  // Applies a deferred seek before a synchronous native call.
+  _flushSeek () {
+    if (this[kSeek] !== null) {
+      const target = this[kSeek]
+      this[kSeek] = null
+      binding.iterator_seek_sync(this[kContext], target)
+    }
   }
 
   _close (callback) {
@@ -73,20 +122,40 @@ class Iterator extends AbstractIterator {
 
   _next (callback) {
     assert(this[kContext])
-    assert(!this[kBusy])
+    assert(!this[kBusy] || this[kPrefetch])
 
     if (this[kPosition] < this[kCache].length) {
-      const key = this[kCache][this[kPosition]++]
-      const val = this[kCache][this[kPosition]++]
+      const key = this[kCache].at(this[kPosition]++)
+      const val = this[kCache].at(this[kPosition]++)
       process.nextTick(callback, null, key, val)
     } else if (this[kFinished]) {
       process.nextTick(callback)
+    } else if (this[kReadAhead]) {
+      const size = this[kFirst] ? 1 : 1000
+      this[kFirst] = false
+
+      this._nextvAsync(size, {}, (err, { rows, finished } = {}) => {
+        if (err) {
+          callback(err)
+        } else if (this[kPosition] < this[kCache].length) {
+          // _deliver() cached a larger read-ahead batch and took `rows` from
+          // its start. Put them back rather than dropping the rest.
+          this[kPosition] -= rows.length
+          this._next(callback)
+        } else {
+          this[kCache] = rows
+          this[kFinished] = finished
+          this[kPosition] = 0
+          this._next(callback)
+        }
+      })
     } else {
       const size = this[kFirst] ? 1 : 1000
       this[kFirst] = false
 
       try {
-        const { rows, finished } = binding.iterator_nextv_sync(this[kContext], size, null)
+        this._flushSeek()
+        const { rows, finished } = this._unpack(binding.iterator_nextv_sync(this[kContext], size, null))
         this[kCache] = rows
         this[kFinished] = finished
         this[kPosition] = 0
@@ -102,7 +171,7 @@ class Iterator extends AbstractIterator {
 
   _nextv (size, options, callback) {
     assert(this[kContext])
-    assert(!this[kBusy])
+    assert(!this[kBusy] || this[kPrefetch])
 
     callback = fromCallback(callback, kPromise)
 
@@ -114,7 +183,7 @@ class Iterator extends AbstractIterator {
 
         const entries = []
         for (let n = 0; n < rows.length; n += 2) {
-          entries.push([rows[n + 0], rows[n + 1]])
+          entries.push([rows.at(n + 0), rows.at(n + 1)])
         }
 
         callback(null, entries, finished, limited)
@@ -130,6 +199,9 @@ class Iterator extends AbstractIterator {
     assert(this[kContext])
     assert(!this[kBusy])
 
+    this[kPrefetch] = null
+    this._flushSeek()
+
     this[kFirst] = true
     this[kCache] = kEmpty
     this[kFinished] = false
@@ -140,7 +212,7 @@ class Iterator extends AbstractIterator {
 
   _seekSync (target) {
     assert(this[kContext])
-    assert(!this[kBusy])
+    assert(!this[kBusy] || this[kPrefetch])
 
     if (target.length === 0) {
       throw new Error('cannot seek() to an empty target')
@@ -150,20 +222,51 @@ class Iterator extends AbstractIterator {
     this[kCache] = kEmpty
     this[kFinished] = false
     this[kPosition] = 0
+    this[kSeek] = null
+
+    const prefetch = this[kPrefetch]
+    if (prefetch && !prefetch.settled) {
+      // The native iterator is in use; seek once the read-ahead completes.
+      prefetch.discarded = true
+      prefetch.seek = target
+      return
+    }
 
+    this[kPrefetch] = null
+    assert(!this[kBusy])
     binding.iterator_seek_sync(this[kContext], target)
   }
 
   _seekAsync (target, callback) {
     assert(this[kContext])
-    assert(!this[kBusy])
 
     callback = fromCallback(callback, kPromise)
 
+    const prefetch = this[kPrefetch]
+    if (prefetch && !prefetch.settled) {
+      prefetch.discarded = true
+      prefetch.waiters.push(() => this._seekAsync(target, callback))
+      return callback[kPromise]
+    }
+
+    this[kPrefetch] = null
+    assert(!this[kBusy])
+
+    if (this[kBatch] !== null) {
+      try {
+        this._seekSync(target)
+        process.nextTick(callback, null)
+      } catch (err) {
+        process.nextTick(callback, err)
+      }
+      return callback[kPromise]
+    }
+
     this[kFirst] = true
     this[kCache] = kEmpty
     this[kFinished] = false
     this[kPosition] = 0
+    this[kSeek] = null
 
     try {
       this[kDB][kRef]()
@@ -191,13 +294,38 @@ class Iterator extends AbstractIterator {
 
   _nextvSync (size, options) {
     assert(this[kContext])
+
+    const prefetch = this[kPrefetch]
+    if (prefetch && !prefetch.settled) {
+      // The read-ahead holds the native iterator and cannot be waited for here.
+      throw new ModuleError('Iterator is busy: a prefetch is in flight', {
+        code: 'LEVEL_ITERATOR_BUSY'
+      })
+    }
+
     assert(!this[kBusy])
 
+    if (prefetch) {
+      this[kPrefetch] = null
+      if (prefetch.err) {
+        throw prefetch.err
+      } else if (!prefetch.discarded) {
+        this[kFinished] = prefetch.result.finished
+        this[kCache] = this._unpack(prefetch.result).rows
+        this[kPosition] = 0
+      }
+    }
+
+    if (this[kPosition] < this[kCache].length) {
+      return this._take(size)
+    }
+
     if (this[kFinished]) {
       return { rows: [], finished: true }
     }
 
-    const result = binding.iterator_nextv_sync(this[kContext], size, options)
+    this._flushSeek()
+    const result = this._unpack(binding.iterator_nextv_sync(this[kContext], size, options))
     this[kFinished] = result.finished
 
     return result
@@ -205,41 +333,170 @@ class Iterator extends AbstractIterator {
 
   _nextvAsync (size, options, callback) {
     assert(this[kContext])
-    assert(!this[kBusy])
 
     callback = fromCallback(callback, kPromise)
 
+    if (this[kPosition] < this[kCache].length) {
+      process.nextTick(callback, null, this._take(size))
+      return callback[kPromise]
+    }
+
+    const prefetch = this[kPrefetch]
+    if (prefetch) {
+      this[kPrefetch] = null
+
+      const deliver = () => {
+        if (prefetch.discarded) {
+          // A seek replaced the read-ahead batch.
+          this._nextvAsync(size, options, callback)
+        } else if (prefetch.err) {
+          callback(prefetch.err)
+        } else {
+          callback(null, this._deliver(prefetch.result, size, options))
+        }
+      }
+
+      if (prefetch.settled) {
+        process.nextTick(deliver)
+      } else {
+        prefetch.waiters.push(deliver)
+      }
+
+      return callback[kPromise]
+    }
+
+    assert(!this[kBusy])
+
+    if (this[kFinished]) {
+      process.nextTick(callback, null, { rows: [], finished: true })
+    } else {
+      this._fetch(size, options, (err, result) => {
+        if (err) {
+          callback(err)
+        } else {
+          callback(null, this._deliver(result, size, options))
+        }
+      })
+    }
+
+    return callback[kPromise]
+  }
+
+  _fetch (size, options, callback) {
+    if (this[kBatch] !== null) {
+      try {
+        this._flushSeek()
+        process.nextTick(callback, null, binding.iterator_nextv_sync(this[kContext], size, options))
+      } catch (err) {
+        process.nextTick(callback, err)
+      }
+      return
+    }
+
+    const target = this[kSeek]
+    this[kSeek] = null
+
+    const done = (err, result) => {
+      this[kBusy] = false
+      this[kDB][kUnref]()
+      callback(err, result)
+      this._flushPendingClose()
+    }
+
     try {
-      if (this[kFinished]) {
-        process.nextTick(callback, null, { rows: [], finished: true })
+      this[kDB][kRef]()
+      this[kBusy] = true
+      if (target !== null) {
+        binding.iterator_seek_nextv(this[kContext], target, size, options, done)
       } else {
-        this[kDB][kRef]()
-        this[kBusy] = true
-        binding.iterator_nextv(this[kContext], size, options, (err, result) => {
-          this[kBusy] = false
-          this[kDB][kUnref]()
-
-          if (err) {
-            callback(err)
-          } else {
-            this[kFinished] = result.finished
-            callback(null, result)
-          }
-
-          this._flushPendingClose()
-        })
+        binding.iterator_nextv(this[kContext], size, options, done)
       }
     } catch (err) {
       this[kBusy] = false
       this[kDB][kUnref]()
       process.nextTick(callback, err)
     }
+  }
 
-    return callback[kPromise]
+  _deliver (result, size, options) {
+    this[kFinished] = result.finished
+    result = this._unpack(result)
+
+    if (result.rows.length > size * 2) {
+      // Read ahead for an earlier, larger request.
+      this[kCache] = result.rows
+      this[kPosition] = 0
+      result = this._take(size)
+    }
+
+    if (this[kReadAhead] && !this[kFinished] && !this[kPendingClose]) {
+      this._prefetch(size, options)
+    }
+
+    return result
+  }
+
+  _prefetch (size, options) {
+    const prefetch = {
+      settled: false,
+      discarded: false,
+      seek: null,
+      err: null,
+      result: null,
+      waiters: []
+    }
+
+    this[kPrefetch] = prefetch
+
+    this._fetch(size, options, (err, result) => {
+      prefetch.settled = true
+      prefetch.err = err
+      prefetch.result = result
+
+      if (prefetch.seek !== null) {
+        try {
+          binding.iterator_seek_sync(this[kContext], prefetch.seek)
+        } catch (err) {
+          prefetch.discarded = false
+          prefetch.err = err
+        }
+      }
+
+      if (prefetch.discarded && this[kPrefetch] === prefetch) {
+        this[kPrefetch] = null
+      }
+
+      for (const waiter of prefetch.waiters) {
+        waiter()
+      }
+    })
+  }
+
+  // Takes up to `size` entries left in the cache, as a plain rows array.
+  _take (size) {
+    const cache = this[kCache]
+    const end = Math.min(cache.length, this[kPosition] + size * 2)
+
+    const rows = []
+    while (this[kPosition] < end) {
+      rows.push(cache.at(this[kPosition]++))
+    }
+
+    const drained = this[kPosition] >= cache.length
+    return { rows, finished: drained && this[kFinished], limited: !drained || !this[kFinished] }
+  }
+
+  _unpack (result) {
+    if (this[kPacked]) {
+      result.rows = new PackedRows(result, this[kPacked])
+    }
+    return result
   }
 
   _closeSync () {
     this[kCache] = kEmpty
+    this[kPrefetch] = null
+    this[kSeek] = null
 
     if (this[kContext]) {
       binding.iterator_close_sync(this[kContext])
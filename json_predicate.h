@@ -0,0 +1,394 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A conjunction of tests on fields of JSON values, e.g. `status == "active"
+// && rev >= 10`. Values are scanned in place without building a document:
+// each distinct path is located with one pass that skips everything outside
+// it. Values are not fully validated; malformed JSON simply fails to match.
+class JsonPredicate {
+ public:
+  enum class Op { Eq, Ne, Lt, Lte, Gt, Gte, Exists };
+
+  struct Operand {
+    enum class Type { String, Number, Bool, Null } type = Type::Null;
+    std::string string;
+    double number = 0;
+    bool boolean = false;
+  };
+
+  struct Test {
+    Op op;
+    Operand operand;
+  };
+
+  void Add(std::vector<std::string> path, Test test) {
+    for (auto& field : fields_) {
+      if (field.path == path) {
+        field.tests.push_back(std::move(test));
+        return;
+      }
+    }
+    fields_.push_back(Field{std::move(path), {std::move(test)}});
+  }
+
+  bool Matches(std::string_view data) const {
+    for (const auto& field : fields_) {
+      const auto value = Find(data, field.path);
+      for (const auto& test : field.tests) {
+        if (!Evaluate(test, value)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+ private:
+  struct Field {
+    std::vector<std::string> path;
+    std::vector<Test> tests;
+  };
+
+  static bool Evaluate(const Test& test, const std::optional<std::string_view>& value) {
+    if (test.op == Op::Exists) {
+      return value.has_value() == test.operand.boolean;
+    }
+
+    if (test.op == Op::Ne) {
+      return !value || Compare(test.operand, *value) != 0;
+    }
+
+    if (!value) {
+      return false;
+    }
+
+    const auto cmp = Compare(test.operand, *value);
+    switch (test.op) {
+      case Op::Eq:
+        return cmp == 0;
+      case Op::Lt:
+        return cmp == -1;
+      case Op::Lte:
+        return cmp == -1 || cmp == 0;
+      case Op::Gt:
+        return cmp == 1;
+      case Op::Gte:
+        return cmp == 1 || cmp == 0;
+      default:
+        return false;
+    }
+  }
+
+  // Compares a raw JSON token to an operand: -1, 0 or 1 when the value is
+  // less than, equal to or greater than it, or 2 when they are of different
+  // types (or not ordered, for booleans and null).
+  static int Compare(const Operand& operand, std::string_view token) {
+    using Type = Operand::Type;
+
+    switch (operand.type) {
+      case Type::String: {
+        if (token.size() < 2 || token.front() != '"') {
+          return 2;
+        }
+        token = token.substr(1, token.size() - 2);
+        std::string unescaped;
+        if (token.find('\\') != std::string_view::npos) {
+          if (!Unescape(token, unescaped)) {
+            return 2;
+          }
+          token = unescaped;
+        }
+        const auto cmp = token.compare(operand.string);
+        return cmp < 0 ? -1 : cmp > 0 ? 1 : 0;
+      }
+      case Type::Number: {
+        double number;
+        const auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), number);
+        if (ec != std::errc() || end != token.data() + token.size()) {
+          return 2;
+        }
+        return number < operand.number ? -1 : number > operand.number ? 1 : number == operand.number ? 0 : 2;
+      }
+      case Type::Bool:
+        return token == (operand.boolean ? "true" : "false") ? 0 : 2;
+      case Type::Null:
+        return token == "null" ? 0 : 2;
+    }
+
+    return 2;
+  }
+
+  // The raw token at `path`, where a segment selects an object member or, if
+  // it is all digits, an array element.
+  static std::optional<std::string_view> Find(std::string_view data, const std::vector<std::string>& path) {
+    size_t pos = SkipSpace(data, 0);
+
+    for (const auto& segment : path) {
+      if (pos >= data.size()) {
+        return std::nullopt;
+      }
+
+      if (data[pos] == '{') {
+        if (!FindMember(data, ++pos, segment)) {
+          return std::nullopt;
+        }
+      } else if (data[pos] == '[') {
+        if (!FindElement(data, ++pos, segment)) {
+          return std::nullopt;
+        }
+      } else {
+        return std::nullopt;
+      }
+    }
+
+    const size_t start = pos;
+    if (!SkipValue(data, pos)) {
+      return std::nullopt;
+    }
+
+    return data.substr(start, pos - start);
+  }
+
+  // Positions `pos` (just past a '{') at the value of member `name`.
+  static bool FindMember(std::string_view data, size_t& pos, std::string_view name) {
+    std::string unescaped;
+
+    while (true) {
+      pos = SkipSpace(data, pos);
+      if (pos >= data.size() || data[pos] != '"') {
+        return false;
+      }
+
+      const size_t start = pos + 1;
+      if (!SkipString(data, pos)) {
+        return false;
+      }
+      auto key = data.substr(start, pos - start - 1);
+      if (key.find('\\') != std::string_view::npos) {
+        if (!Unescape(key, unescaped)) {
+          return false;
+        }
+        key = unescaped;
+      }
+
+      pos = SkipSpace(data, pos);
+      if (pos >= data.size() || data[pos] != ':') {
+        return false;
+      }
+      pos = SkipSpace(data, pos + 1);
+
+      if (key == name) {
+        return true;
+      }
+
+      if (!SkipValue(data, pos)) {
+        return false;
+      }
+
+      pos = SkipSpace(data, pos);
+      if (pos >= data.size() || data[pos] != ',') {
+        return false;
+      }
+      pos++;
+    }
+  }
+
+  // Positions `pos` (just past a '[') at element `index`.
+  static bool FindElement(std::string_view data, size_t& pos, std::string_view index) {
+    size_t n;
+    const auto [end, ec] = std::from_chars(index.data(), index.data() + index.size(), n);
+    if (ec != std::errc() || end != index.data() + index.size()) {
+      return false;
+    }
+
+    pos = SkipSpace(data, pos);
+    if (pos < data.size() && data[pos] == ']') {
+      return false;
+    }
+
+    for (; n > 0; n--) {
+      if (!SkipValue(data, pos)) {
+        return false;
+      }
+      pos = SkipSpace(data, pos);
+      if (pos >= data.size() || data[pos] != ',') {
+        return false;
+      }
+      pos = SkipSpace(data, pos + 1);
+    }
+
+    return pos < data.size();
+  }
+
+  static size_t SkipSpace(std::string_view data, size_t pos) {
+    while (pos < data.size() && (data[pos] == ' ' || data[pos] == '\n' || data[pos] == '\r' || data[pos] == '\t')) {
+      pos++;
+    }
+    return pos;
+  }
+
+  // Advances `pos` from an opening quote to just past the closing one.
+  static bool SkipString(std::string_view data, size_t& pos) {
+    pos++;
+    while (true) {
+      const auto quote = static_cast<const char*>(std::memchr(data.data() + pos, '"', data.size() - pos));
+      if (!quote) {
+        return false;
+      }
+
+      // The quote is escaped if preceded by an odd number of backslashes.
+      const size_t end = quote - data.data();
+      size_t backslashes = 0;
+      while (end - backslashes > pos && data[end - backslashes - 1] == '\\') {
+        backslashes++;
+      }
+
+      pos = end + 1;
+      if (backslashes % 2 == 0) {
+        return true;
+      }
+    }
+  }
+
+  static bool SkipValue(std::string_view data, size_t& pos) {
+    if (pos >= data.size()) {
+      return false;
+    }
+
+    if (data[pos] == '"') {
+      return SkipString(data, pos);
+    }
+
+    if (data[pos] == '{' || data[pos] == '[') {
+      size_t depth = 0;
+      while (pos < data.size()) {
+        switch (data[pos]) {
+          case '"':
+            if (!SkipString(data, pos)) {
+              return false;
+            }
+            continue;
+          case '{':
+          case '[':
+            depth++;
+            break;
+          case '}':
+          case ']':
+            if (--depth == 0) {
+              pos++;
+              return true;
+            }
+            break;
+        }
+        pos++;
+      }
+      return false;
+    }
+
+    const size_t start = pos;
+    while (pos < data.size() && data[pos] != ',' && data[pos] != '}' && data[pos] != ']' && data[pos] != ' ' &&
+           data[pos] != '\n' && data[pos] != '\r' && data[pos] != '\t') {
+      pos++;
+    }
+    return pos > start;
+  }
+
+  static bool Unescape(std::string_view data, std::string& result) {
+    result.clear();
+    result.reserve(data.size());
+
+    for (size_t n = 0; n < data.size(); n++) {
+      if (data[n] != '\\') {
+        result.push_back(data[n]);
+        continue;
+      }
+
+      if (++n >= data.size()) {
+        return false;
+      }
+
+      switch (data[n]) {
+        case '"':
+        case '\\':
+        case '/':
+          result.push_back(data[n]);
+          break;
+        case 'b':
+          result.push_back('\b');
+          break;
+        case 'f':
+          result.push_back('\f');
+          break;
+        case 'n':
+          result.push_back('\n');
+          break;
+        case 'r':
+          result.push_back('\r');
+          break;
+        case 't':
+          result.push_back('\t');
+          break;
+        case 'u': {
+          uint32_t code;
+          if (!ReadHex(data, n + 1, code)) {
+            return false;
+          }
+          n += 4;
+
+          // A high surrogate must be followed by an escaped low surrogate.
+          if (code >= 0xd800 && code <= 0xdbff) {
+            uint32_t low;
+            if (n + 2 >= data.size() || data[n + 1] != '\\' || data[n + 2] != 'u' || !ReadHex(data, n + 3, low) ||
+                low < 0xdc00 || low > 0xdfff) {
+              return false;
+            }
+            n += 6;
+            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+          }
+
+          EncodeUtf8(result, code);
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+  static bool ReadHex(std::string_view data, size_t pos, uint32_t& result) {
+    if (pos + 4 > data.size()) {
+      return false;
+    }
+    const auto [end, ec] = std::from_chars(data.data() + pos, data.data() + pos + 4, result, 16);
+    return ec == std::errc() && end == data.data() + pos + 4;
+  }
+
+  static void EncodeUtf8(std::string& to, uint32_t code) {
+    if (code < 0x80) {
+      to.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      to.push_back(static_cast<char>(0xc0 | (code >> 6)));
+      to.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else if (code < 0x10000) {
+      to.push_back(static_cast<char>(0xe0 | (code >> 12)));
+      to.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+      to.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else {
+      to.push_back(static_cast<char>(0xf0 | (code >> 18)));
+      to.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+      to.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+      to.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    }
+  }
+
+  std::vector<Field> fields_;
+};
@@ -0,0 +1,97 @@
+'use strict'
+
+// Lazy view over a `format: 'packed'` batch. Native code writes every key and
+// value into one `buffer` and `offsets` holds count * 2 + 1 boundaries, so
+// element n (same indexing as the flat `rows` array: key, value, key, ...)
+// spans [offsets[n], offsets[n + 1]). Elements are only sliced or decoded when
+// read.
+class PackedRows {
+  constructor ({ buffer, offsets }, { keys = true, values = true, keyEncoding, valueEncoding } = {}) {
+    this.buffer = buffer
+    this.offsets = offsets
+    this.keys = keys !== false
+    this.values = values !== false
+    this.keyEncoding = keyEncoding ?? 'buffer'
+    this.valueEncoding = valueEncoding ?? 'buffer'
+  }
+
+  get length () {
+    return this.offsets.length - 1
+  }
+
+  at (index) {
+    if (index < 0 || index >= this.length) {
+      return undefined
+    }
+
+    if (index % 2 === 0) {
+      return this.keys ? this._decode(index, this.keyEncoding) : undefined
+    } else {
+      return this.values ? this._decode(index, this.valueEncoding) : undefined
+    }
+  }
+
+  _decode (index, encoding) {
+    const start = this.offsets[index]
+    const end = this.offsets[index + 1]
+    return encoding === 'buffer'
+      ? this.buffer.subarray(start, end)
+      : this.buffer.toString('utf8', start, end)
+  }
+
+  * [Symbol.iterator] () {
+    for (let n = 0; n < this.length; n++) {
+      yield this.at(n)
+    }
+  }
+}
+
+// Lazy view over a `format: 'packed'` getMany result. `offsets` holds
+// count + 1 offsets (value n spans [offsets[n], offsets[n + 1])), followed by a
+// found bitmap and an incomplete (aborted / timed out) bitmap of
+// ceil(count / 32) words each. at(n) mirrors the array format: the value,
+// null if incomplete or undefined if not found.
+class PackedValues {
+  constructor ({ buffer, offsets }, count, { valueEncoding } = {}) {
+    this.buffer = buffer
+    this.offsets = offsets
+    this.length = count
+    this.valueEncoding = valueEncoding ?? 'buffer'
+  }
+
+  // Minimum `offsets` length for a caller-supplied output of `count` keys.
+  static indexLength (count) {
+    return count + 1 + 2 * Math.ceil(count / 32)
+  }
+
+  at (index) {
+    if (index < 0 || index >= this.length) {
+      return undefined
+    }
+
+    const words = Math.ceil(this.length / 32)
+    const bit = 1 << (index % 32)
+    const word = this.length + 1 + (index >>> 5)
+
+    if (this.offsets[word] & bit) {
+      const start = this.offsets[index]
+      const end = this.offsets[index + 1]
+      return this.valueEncoding === 'buffer'
+        ? this.buffer.subarray(start, end)
+        : this.buffer.toString('utf8', start, end)
+    } else if (this.offsets[word + words] & bit) {
+      return null
+    } else {
+      return undefined
+    }
+  }
+
+  * [Symbol.iterator] () {
+    for (let n = 0; n < this.length; n++) {
+      yield this.at(n)
+    }
+  }
+}
+
+exports.PackedRows = PackedRows
+exports.PackedValues = PackedValues
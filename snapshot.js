@@ -0,0 +1,68 @@
+'use strict'
+
+const ModuleError = require('module-error')
+const binding = require('./binding')
+
+const kContext = Symbol('context')
+const kDB = Symbol('db')
+
+// A consistent view of the database as of its creation, for reads that pass
+// it as the `snapshot` option. Released by close() or when the db closes.
+class Snapshot {
+  constructor (db, context) {
+    this[kDB] = db
+    this[kContext] = binding.snapshot_init(context)
+  }
+
+  get sequence () {
+    return binding.snapshot_get_sequence(this._context(this[kDB]))
+  }
+
+  get closed () {
+    return this[kContext] === null
+  }
+
+  close () {
+    if (this[kContext] !== null) {
+      binding.snapshot_close(this[kContext])
+      this[kContext] = null
+    }
+  }
+
+  [Symbol.dispose] () {
+    this.close()
+  }
+
+  _context (db) {
+    if (db !== this[kDB]) {
+      throw new ModuleError('Snapshot belongs to another database', {
+        code: 'LEVEL_INVALID_VALUE'
+      })
+    }
+
+    if (this[kContext] === null || db.status !== 'open') {
+      throw new ModuleError('Snapshot is closed', {
+        code: 'LEVEL_SNAPSHOT_CLOSED'
+      })
+    }
+
+    return this[kContext]
+  }
+}
+
+// Swaps a Snapshot in read options for its native handle.
+function snapshotOptions (db, options) {
+  const snapshot = options?.snapshot
+  if (snapshot == null) {
+    return options
+  }
+
+  if (!(snapshot instanceof Snapshot)) {
+    throw new TypeError("The 'snapshot' option must be a Snapshot")
+  }
+
+  return { ...options, snapshot: snapshot._context(db) }
+}
+
+exports.Snapshot = Snapshot
+exports.snapshotOptions = snapshotOptions
@@ -0,0 +1,38 @@
+'use strict'
+
+// Coverage for approximateSize() / approximateCount(), which estimate ranges
+// from RocksDB's size approximations instead of scanning them.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+test('approximate size and count', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+
+  const batch = db.batch()
+  for (let i = 0; i < 1000; i++) batch.put('key' + String(i).padStart(4, '0'), Buffer.alloc(100, i & 0xff))
+  await batch.write()
+
+  const memtable = db.approximateCount({ gte: 'key0000', lt: 'key1000' })
+  t.ok(memtable > 500 && memtable < 1500, 'memtable count is close')
+
+  await db.compactRange()
+
+  const [all, half, none] = db.approximateSize([
+    { gte: 'key0000', lt: 'key1000' },
+    { gte: 'key0000', lt: 'key0500' },
+    { gt: 'z', lte: 'zz' }
+  ])
+  t.ok(all > 0, 'whole range has a size')
+  t.ok(half <= all, 'half the range is no larger')
+  t.equal(none, 0, 'empty range')
+
+  const count = db.approximateCount({ gte: 'key0000', lt: 'key1000' })
+  t.ok(count > 500 && count < 1500, 'file count is close')
+
+  t.throws(() => db.approximateSize({ gte: 'a' }), 'requires an upper bound')
+
+  await db.close()
+  t.end()
+})
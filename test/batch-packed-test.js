@@ -0,0 +1,80 @@
+'use strict'
+
+// Coverage for batch_append_packed, which appends a whole opcode / column /
+// key / value stream to a WriteBatch in one call (see BatchEncoder).
+
+const test = require('tape')
+const testCommon = require('./common')
+const binding = require('../binding')
+const { BatchEncoder } = require('../chained-batch')
+
+test('chained and array batches are encoded in one call', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+
+  const batch = db.batch()
+  for (let i = 0; i < 1000; i++) batch.put('key' + i, 'value' + i)
+  batch.del('key0')
+  batch.put(Buffer.from('ü'), Buffer.alloc(8192, 1))
+  t.equal(batch.length, 1002, 'length counts encoded operations')
+  await batch.write()
+
+  t.same(await db.getMany(['key0', 'key1', 'key999']), [undefined, 'value1', 'value999'], 'chained batch applied')
+  t.ok((await db.get('ü', { valueEncoding: 'buffer' })).equals(Buffer.alloc(8192, 1)), 'large value grows the buffer')
+
+  await db.batch([
+    { type: 'del', key: 'key1' },
+    { type: 'put', key: 'key2', value: 'other' }
+  ])
+  t.same(await db.getMany(['key1', 'key2']), [undefined, 'other'], 'array batch applied')
+
+  await db.close()
+  t.end()
+})
+
+test('batch_append_packed rejects malformed streams', async function (t) {
+  const batch = binding.batch_init()
+
+  const encoder = new BatchEncoder()
+  encoder.put('a', 'b')
+  const data = encoder.buffer.subarray(0, encoder.length)
+
+  t.throws(() => binding.batch_append_packed(batch, data.subarray(0, data.length - 1), []), 'truncated value')
+  t.throws(() => binding.batch_append_packed(batch, Buffer.from([9, 0, 0, 0, 0, 0]), []), 'unknown opcode')
+  t.throws(() => binding.batch_append_packed(batch, Buffer.from([2, 1, 0, 0, 0, 0]), []), 'unknown column')
+  t.equal(binding.batch_count(batch), 0, 'nothing appended on error')
+
+  binding.batch_append_packed(batch, data, [])
+  t.equal(binding.batch_count(batch), 1, 'valid stream appended')
+
+  binding.batch_clear(batch)
+  t.end()
+})
+
+test('an invalid column fails its own op only', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+
+  const batch = db.batch()
+  batch.put('a', '1')
+  t.throws(() => batch.put('b', '2', { column: {} }), /column/, 'rejected when added')
+  batch.del('c')
+  t.equal(batch.length, 2, 'other ops are kept')
+  await batch.write()
+  t.same(await db.getMany(['a', 'b']), ['1', undefined], 'and written')
+
+  const encoder = new BatchEncoder()
+  t.equal(encoder.buffer.length, 0, 'nothing is allocated before the first op')
+  encoder.put('a', 'b')
+  t.ok(encoder.buffer.length <= 64, 'a small op allocates a small buffer')
+
+  const native = binding.batch_init()
+  encoder.columns.push({})
+  encoder.buffer[1] = 1
+  t.throws(() => encoder.flush(native), 'a failed flush throws')
+  t.equal(encoder.length, 0, 'and resets the encoder')
+  binding.batch_clear(native)
+
+  await db.close()
+  t.end()
+})
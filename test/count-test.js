@@ -0,0 +1,30 @@
+'use strict'
+
+// Coverage for count() / countSync(), which tally a range natively without
+// materializing rows.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+test('count and countSync', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+
+  const batch = db.batch()
+  for (let i = 0; i < 100; i++) batch.put('key' + String(i).padStart(2, '0'), i % 2 ? 'odd' : 'even!')
+  await batch.write()
+
+  t.same(db.countSync(), { count: 100, keyBytes: 500, valueBytes: 50 * 3 + 50 * 5 }, 'whole db')
+  t.same(await db.count(), db.countSync(), 'async matches sync')
+
+  t.equal(db.countSync({ gte: 'key10', lt: 'key20' }).count, 10, 'range')
+  t.equal(db.countSync({ limit: 7 }).count, 7, 'limit')
+  t.equal(db.countSync({ keyFilter: '^key1' }).count, 10, 'key filter')
+  t.equal(db.countSync({ valueFilter: 'odd', limit: 30 }).count, 30, 'limit counts matches only')
+  t.same(db.countSync({ values: false }), { count: 100, keyBytes: 500, valueBytes: 0 }, 'values: false skips value bytes')
+
+  t.throws(() => db.countSync({ keyFilter: '(' }), 'invalid filter')
+
+  await db.close()
+  t.end()
+})
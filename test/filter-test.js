@@ -225,6 +225,23 @@ test('filter matches all entries when pattern is broad', async function (t) {
   t.equal(entries.length, 8, 'should return all 8 entries')
 })
 
+test('keyFilter with an array of patterns', async function (t) {
+  const keys = async (keyFilter, options) => (await db.keys({ keyFilter, ...options }).all())
+
+  t.same(await keys(['^user:1', '^post:', '^log:info']), ['log:info:1', 'post:1', 'post:2', 'user:1'], 'prefixes')
+  t.same(await keys(['^user:1', '^post:'], { reverse: true }), ['user:1', 'post:2', 'post:1'], 'prefixes in reverse')
+  t.same(await keys(['^user:1', '^post:'], { gt: 'post:1', limit: 2 }), ['post:2', 'user:1'], 'prefixes with bounds and limit')
+  t.same(await keys(['^zzz']), [], 'prefix past the last key')
+  t.same(await keys([':2$', '^user:3$']), ['log:error:2', 'post:2', 'user:2', 'user:3'], 'suffix and exact literals')
+  t.same(await keys(['info', 'user:[13]']), ['log:info:1', 'user:1', 'user:3'], 'literal and regex mixed')
+  t.same(await keys(['^user:\\d$', 'error']), ['log:error:1', 'log:error:2', 'user:1', 'user:2', 'user:3'], 'regex set')
+
+  const values = await db.values({ valueFilter: ['alice', '^wor'] }).all()
+  t.same(values, ['world', 'alice'], 'value filter array')
+
+  t.throws(() => db.querySync({ keyFilter: ['^user:', '('] }), 'invalid pattern in array')
+})
+
 test('filter tests teardown', async function (t) {
   return db.close()
 })
@@ -0,0 +1,55 @@
+'use strict'
+
+// Coverage for the opt-in `coalesceGets` mode, where gets issued in the same
+// tick are answered by one db_get_many per column and read options.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+test('coalesced gets resolve individually', async function (t) {
+  const db = testCommon.factory({ coalesceGets: true })
+  await db.open()
+
+  const batch = db.batch()
+  for (let i = 0; i < 100; i++) batch.put('key' + i, 'value' + i)
+  await batch.write()
+
+  const keys = []
+  for (let i = 0; i < 100; i++) keys.push('key' + i)
+
+  const values = await Promise.all(keys.map((key) => db.get(key)))
+  t.same(values, keys.map((key) => key.replace('key', 'value')), 'all values in order')
+
+  const [buffer, string] = await Promise.all([
+    db.get('key1', { valueEncoding: 'buffer' }),
+    db.get('key1', { valueEncoding: 'utf8' })
+  ])
+  t.ok(buffer.equals(Buffer.from('value1')), 'buffer encoding is batched separately')
+  t.equal(string, 'value1', 'utf8 encoding is batched separately')
+
+  const results = await Promise.allSettled([db.get('key2'), db.get('missing')])
+  t.equal(results[0].value, 'value2', 'found key resolves')
+  t.equal(results[1].reason.code, 'LEVEL_NOT_FOUND', 'missing key rejects alone')
+
+  const pending = db.get('key3')
+  await db.close()
+  t.equal(await pending, 'value3', 'close waits for a queued get')
+
+  t.end()
+})
+
+test('gets with a timeout or byte limit are not coalesced', async function (t) {
+  const db = testCommon.factory({ coalesceGets: true })
+  await db.open()
+  await db.batch(['a', 'b', 'c'].map((key) => ({ type: 'put', key, value: 'V' + key })))
+
+  // A shared limit of one byte would abort all but the first value.
+  const limited = await Promise.all(['a', 'b', 'c'].map((key) => db.get(key, { highWaterMarkBytes: 1 })))
+  t.same(limited, ['Va', 'Vb', 'Vc'], 'highWaterMarkBytes')
+
+  const timed = await Promise.all(['a', 'b', 'c'].map((key) => db.get(key, { timeout: 60e3 })))
+  t.same(timed, ['Va', 'Vb', 'Vc'], 'timeout')
+
+  await db.close()
+  t.end()
+})
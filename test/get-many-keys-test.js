@@ -0,0 +1,68 @@
+'use strict'
+
+// Coverage for passing getMany keys in one piece: a `{ buffer, offsets }` or
+// `{ string, offsets }` pair where key n spans [offsets[n], offsets[n + 1]),
+// instead of an array with one element per key.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+const keys = ['a', 'missing', 'ü', '😀', 'b']
+
+async function setup () {
+  const db = testCommon.factory()
+  await db.open()
+  const batch = db.batch()
+  for (const k of keys) if (k !== 'missing') batch.put(k, 'V' + k)
+  await batch.write()
+  return db
+}
+
+function pack (keys, encode) {
+  const offsets = new Uint32Array(keys.length + 1)
+  let length = 0
+  keys.forEach((k, n) => { offsets[n + 1] = length += encode(k) })
+  return offsets
+}
+
+test('getMany with packed keys', async function (t) {
+  const db = await setup()
+  const options = { valueEncoding: 'utf8' }
+  const expected = keys.map((k) => k === 'missing' ? undefined : 'V' + k)
+
+  const buffer = {
+    buffer: Buffer.from(keys.join('')),
+    offsets: pack(keys, (k) => Buffer.byteLength(k))
+  }
+  const string = {
+    string: keys.join(''),
+    offsets: pack(keys, (k) => k.length)
+  }
+
+  for (const [label, input] of [['array', keys], ['buffer', buffer], ['string', string]]) {
+    t.same(db._getManySync(input, options), expected, `${label}: sync`)
+    t.same(await db._getManyAsync(input, options), expected, `${label}: async`)
+  }
+
+  const mixed = [Buffer.from('a'), 'b', 'missing']
+  t.same(db._getManySync(mixed, options), ['Va', 'Vb', undefined], 'mixed strings and buffers')
+
+  const packed = db._getManySync(string, { ...options, format: 'packed' })
+  t.same([...packed], expected, 'combines with packed output')
+
+  await db.close()
+  t.end()
+})
+
+test('getMany rejects invalid packed keys', async function (t) {
+  const db = await setup()
+
+  const buffer = Buffer.from('ab')
+  t.throws(() => db._getManySync({ buffer, offsets: new Uint32Array([0, 2, 1]) }), 'decreasing offsets')
+  t.throws(() => db._getManySync({ buffer, offsets: new Uint32Array([0, 3]) }), 'offsets past the buffer')
+  t.throws(() => db._getManySync({ string: 'ab', offsets: new Uint32Array([0, 3]) }), 'offsets past the string')
+  t.throws(() => db._getManySync({ buffer, offsets: [0, 1, 2] }), 'offsets must be a Uint32Array')
+
+  await db.close()
+  t.end()
+})
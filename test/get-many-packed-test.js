@@ -0,0 +1,75 @@
+'use strict'
+
+// Coverage for getMany `format: 'packed'`: values come back as one slab plus an
+// index (offsets + found/incomplete bitmaps), either natively allocated and
+// wrapped in a PackedValues view, or written into a caller-supplied buffer.
+
+const test = require('tape')
+const testCommon = require('./common')
+const { PackedValues } = require('..')
+
+async function setup () {
+  const db = testCommon.factory()
+  await db.open()
+  const batch = db.batch()
+  for (let i = 0; i < 40; i++) batch.put('key' + i, 'value' + i)
+  await batch.write()
+  return db
+}
+
+// More than 32 keys so the bitmaps span several words.
+const keys = []
+for (let i = 0; i < 40; i++) keys.push(i % 3 === 0 ? 'missing' + i : 'key' + i)
+
+test('packed getMany matches the array format', async function (t) {
+  const db = await setup()
+
+  const expected = db._getManySync(keys, { valueEncoding: 'utf8' })
+
+  const sync = db._getManySync(keys, { valueEncoding: 'utf8', format: 'packed' })
+  t.ok(sync instanceof PackedValues, 'sync returns a PackedValues view')
+  t.equal(sync.length, keys.length, 'one slot per key')
+  t.same([...sync], expected, 'sync values match')
+
+  const async = await db._getManyAsync(keys, { valueEncoding: 'utf8', format: 'packed' })
+  t.same([...async], expected, 'async values match')
+
+  const buffers = db._getManySync(keys, { format: 'packed' })
+  t.ok(Buffer.isBuffer(buffers.at(1)), 'buffer encoding yields buffer views')
+  t.equal(buffers.at(0), undefined, 'missing keys are undefined')
+
+  await db.close()
+  t.end()
+})
+
+test('packed getMany into a caller-supplied buffer', async function (t) {
+  const db = await setup()
+
+  const offsets = new Uint32Array(PackedValues.indexLength(keys.length))
+  const expected = db._getManySync(keys, { valueEncoding: 'utf8' })
+  const size = expected.reduce((acc, val) => acc + (val ? Buffer.byteLength(val) : 0), 0)
+
+  {
+    const buffer = Buffer.alloc(4)
+    const needed = db._getManySync(keys, { format: 'packed', buffer, offsets })
+    t.equal(needed, size, 'returns the required size')
+    t.ok(buffer.equals(Buffer.alloc(4)), 'a too small buffer is left untouched')
+  }
+
+  for (const [label, getMany] of [
+    ['sync', (options) => db._getManySync(keys, options)],
+    ['async', (options) => db._getManyAsync(keys, options)]
+  ]) {
+    const buffer = Buffer.alloc(1024)
+    const written = await getMany({ format: 'packed', buffer, offsets })
+    t.equal(written, size, `${label}: returns the number of value bytes`)
+    t.same([...new PackedValues({ buffer, offsets }, keys.length, { valueEncoding: 'utf8' })], expected,
+      `${label}: values decode from the caller buffer`)
+  }
+
+  t.throws(() => db._getManySync(keys, { format: 'packed', buffer: Buffer.alloc(1024), offsets: new Uint32Array(1) }),
+    'rejects a too small offsets table')
+
+  await db.close()
+  t.end()
+})
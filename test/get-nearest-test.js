@@ -0,0 +1,67 @@
+'use strict'
+
+// Coverage for getFloor() / getCeiling() and their batched and sync variants.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+async function setup () {
+  const db = testCommon.factory()
+  await db.open()
+  await db.batch(['doc@02', 'doc@05', 'doc@09'].map((key) => ({ type: 'put', key, value: 'V' + key })))
+  return db
+}
+
+const options = { keyEncoding: 'utf8', valueEncoding: 'utf8' }
+
+test('getFloor and getCeiling', async function (t) {
+  const db = await setup()
+
+  t.same(await db.getFloor('doc@07', options), ['doc@05', 'Vdoc@05'], 'floor between keys')
+  t.same(await db.getFloor('doc@05', options), ['doc@05', 'Vdoc@05'], 'floor is inclusive')
+  t.is(await db.getFloor('doc@01', options), undefined, 'no floor')
+  t.same(await db.getCeiling('doc@07', options), ['doc@09', 'Vdoc@09'], 'ceiling between keys')
+  t.is(await db.getCeiling('doc@10', options), undefined, 'no ceiling')
+
+  t.same(db.getFloorSync('doc@99', options), ['doc@09', 'Vdoc@09'], 'sync floor')
+  t.same(db.getCeilingSync('a', options), ['doc@02', 'Vdoc@02'], 'sync ceiling')
+
+  t.same(await db.getFloorMany(['doc@01', 'doc@03', 'doc@09'], options), [
+    undefined,
+    ['doc@02', 'Vdoc@02'],
+    ['doc@09', 'Vdoc@09']
+  ], 'batched')
+  t.same(await db.getCeilingMany([], options), [], 'empty batch')
+
+  await db.close()
+  t.end()
+})
+
+test('getFloor sees later writes and honours snapshots', async function (t) {
+  const db = await setup()
+
+  t.same(await db.getFloor('doc@07', options), ['doc@05', 'Vdoc@05'])
+  const snapshot = db.snapshot()
+  await db.put('doc@06', 'new')
+
+  t.same(await db.getFloor('doc@07', options), ['doc@06', 'new'], 'pooled iterators are refreshed')
+  t.same(await db.getFloor('doc@07', { ...options, snapshot }), ['doc@05', 'Vdoc@05'], 'snapshot')
+
+  snapshot.close()
+  await db.close()
+  t.end()
+})
+
+test('getFloor and getCeiling cross prefixes of a prefix extractor', async function (t) {
+  const db = testCommon.factory({ columns: { default: { prefixExtractor: 'rocksdb.FixedPrefix.2' } } })
+  await db.open()
+  await db.batch(['aa1', 'cc5'].map((key) => ({ type: 'put', key, value: 'V' + key })))
+
+  t.same(await db.getFloor('bb0', options), ['aa1', 'Vaa1'], 'floor in an earlier prefix')
+  t.same(await db.getCeiling('bb0', options), ['cc5', 'Vcc5'], 'ceiling in a later prefix')
+  t.same(db.getFloorSync('cc0', options), ['aa1', 'Vaa1'], 'sync floor')
+  t.same(await db.getCeilingMany(['ab', 'cc9'], options), [['cc5', 'Vcc5'], undefined], 'batched')
+
+  await db.close()
+  t.end()
+})
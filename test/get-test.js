@@ -0,0 +1,50 @@
+'use strict'
+
+// Coverage for the single-key db_get / db_get_sync bindings behind get() and
+// _getSync(), which bypass the getMany vectors.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+test('get and getSync', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+  await db.put('a', 'Va')
+  await db.put(Buffer.from([0xff]), 'Vff')
+
+  t.equal(await db.get('a'), 'Va', 'string key')
+  t.equal(await db.get(Buffer.from([0xff])), 'Vff', 'buffer key')
+  t.ok((await db.get('a', { valueEncoding: 'buffer' })).equals(Buffer.from('Va')), 'buffer value')
+
+  try {
+    await db.get('missing')
+    t.fail('should have thrown')
+  } catch (err) {
+    t.equal(err.code, 'LEVEL_NOT_FOUND', 'missing key rejects with LEVEL_NOT_FOUND')
+  }
+
+  t.equal(db._getSync('a', { valueEncoding: 'utf8' }), 'Va', 'sync string value')
+  t.equal(db._getSync('missing', { valueEncoding: 'utf8' }), undefined, 'sync missing key is undefined')
+
+  const unsafe = db._getSync('a', { valueEncoding: 'buffer', unsafe: true })
+  t.ok(unsafe.equals(Buffer.from('Va')), 'unsafe value')
+
+  await db.close()
+  t.end()
+})
+
+test('get and getSync honour timeout', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+  await db.put('a', 'Va')
+
+  t.equal(await db.get('a', { timeout: 60e3 }), 'Va', 'async within the deadline')
+  t.equal(db._getSync('a', { valueEncoding: 'utf8', timeout: 60e3 }), 'Va', 'sync within the deadline')
+
+  // A 1ms deadline may or may not pass; a timed out read results in null.
+  const value = await db.get('a', { timeout: 1 })
+  t.ok(value === 'Va' || value === null, 'async value or null')
+
+  await db.close()
+  t.end()
+})
@@ -0,0 +1,94 @@
+'use strict'
+
+const test = require('tape')
+const testCommon = require('./common')
+
+const options = { keyEncoding: 'utf8', valueEncoding: 'utf8' }
+
+async function setup () {
+  const db = testCommon.factory()
+  await db.open()
+  await db.batch([
+    { type: 'put', key: 'a', value: 'db' },
+    { type: 'put', key: 'b', value: 'db' },
+    { type: 'put', key: 'c', value: 'db' }
+  ])
+  return db
+}
+
+test('indexed batch reads its own writes', async function (t) {
+  const db = await setup()
+  const batch = db.indexedBatch()
+
+  batch.put('b', 'batch')
+  batch.del('c')
+  batch.put('d', 'batch')
+
+  t.is(batch.getSync('a', options), 'db', 'falls back to the db')
+  t.is(batch.getSync('b', options), 'batch', 'pending put')
+  t.is(batch.getSync('c', options), undefined, 'pending del')
+  t.is(await batch.get('d', options), 'batch', 'async')
+  t.same(await batch.getMany(['a', 'b', 'c', 'd', 'e'], options), ['db', 'batch', undefined, 'batch', undefined], 'getMany')
+  t.same(await batch.iterator(options).all(), [['a', 'db'], ['b', 'batch'], ['d', 'batch']], 'iterator')
+  t.same(await batch.iterator({ ...options, gt: 'a', reverse: true }).all(), [['d', 'batch'], ['b', 'batch']], 'iterator range')
+
+  t.same(await db.iterator(options).all(), [['a', 'db'], ['b', 'db'], ['c', 'db']], 'nothing written yet')
+
+  await batch.write()
+  t.same(await db.iterator(options).all(), [['a', 'db'], ['b', 'batch'], ['d', 'batch']], 'written')
+
+  await db.close()
+  t.end()
+})
+
+test('indexed batch iterators outlive clear()', async function (t) {
+  const db = await setup()
+  const batch = db.indexedBatch()
+
+  batch.put('a', 'batch')
+  const it = batch.iterator({ ...options, limit: 1 })
+  batch.clear()
+  batch.put('b', 'batch')
+
+  t.same(await it.all(), [['a', 'batch']], 'the iterator reads the cleared writes')
+  t.is(batch.getSync('a', options), 'db', 'the batch does not')
+  t.is(batch.getSync('b', options), 'batch')
+
+  await batch.close()
+  await db.close()
+  t.end()
+})
+
+test('indexed batch with snapshot and columns', async function (t) {
+  const db = testCommon.factory({ columns: { default: {}, other: {} } })
+  await db.open()
+  await db.put('a', 'old')
+
+  const snapshot = db.snapshot()
+  await db.put('a', 'new')
+
+  const batch = db.indexedBatch()
+  batch.put('b', 'batch')
+  batch.put('a', 'other', { column: db.columns.other })
+
+  t.is(batch.getSync('a', { ...options, snapshot }), 'old', 'snapshot')
+  t.same(await batch.iterator({ ...options, snapshot }).all(), [['a', 'old'], ['b', 'batch']], 'iterator snapshot')
+  t.is(batch.getSync('a', { ...options, column: db.columns.other }), 'other', 'column')
+
+  snapshot.close()
+  await batch.close()
+  await db.close()
+  t.end()
+})
+
+test('plain batches cannot be read', async function (t) {
+  const db = await setup()
+  const batch = db.batch()
+
+  t.throws(() => batch.getSync('a'), /Batch is not indexed/)
+  t.throws(() => batch.iterator(), /Batch is not indexed/)
+
+  await batch.close()
+  await db.close()
+  t.end()
+})
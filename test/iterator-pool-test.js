@@ -0,0 +1,77 @@
+'use strict'
+
+// Iterators over the latest state are pooled and reused with new bounds; these
+// check that reuse never leaks bounds or stale data from a previous query.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+const options = { keyEncoding: 'utf8', valueEncoding: 'utf8' }
+
+test('pooled iterators are re-bounded', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+  await db.batch(['a', 'b', 'c', 'd'].map((key) => ({ type: 'put', key, value: key })))
+
+  for (let n = 0; n < 3; n++) {
+    t.same(db.querySync({ ...options, gte: 'b', lt: 'd' }).rows, ['b', 'b', 'c', 'c'], 'gte and lt')
+    t.same(db.querySync({ ...options, gt: 'b', lte: 'd' }).rows, ['c', 'c', 'd', 'd'], 'gt and lte')
+    t.same(db.querySync({ ...options, gte: 'c' }).rows, ['c', 'c', 'd', 'd'], 'lower bound only')
+    t.same(db.querySync({ ...options, lt: 'b', reverse: true }).rows, ['a', 'a'], 'upper bound only')
+    t.same(db.querySync({ ...options, limit: 1 }).rows, ['a', 'a'], 'unbounded')
+  }
+
+  await db.close()
+  t.end()
+})
+
+test('pooled iterators see later writes', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+  await db.put('a', '1')
+
+  t.same(db.querySync(options).rows, ['a', '1'])
+  await db.batch([{ type: 'put', key: 'a', value: '2' }, { type: 'put', key: 'b', value: '2' }])
+  t.same(db.querySync(options).rows, ['a', '2', 'b', '2'], 'query')
+  t.same(await db.iterator(options).all(), [['a', '2'], ['b', '2']], 'iterator')
+
+  const it = db.iterator({ ...options, gte: 'b' })
+  await db.del('b')
+  t.same(await it.all(), [['b', '2']], 'an open iterator keeps its view')
+  t.same(db.querySync({ ...options, gte: 'b' }).rows, [], 'until it is back in the pool')
+
+  await db.close()
+  t.end()
+})
+
+test('pooled iterators are released on close', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+  await db.put('a', '1')
+
+  db.querySync(options)
+  db.iterator(options)
+  await db.close()
+
+  await db.open()
+  t.same(db.querySync(options).rows, ['a', '1'], 'reopened')
+  await db.close()
+  t.end()
+})
+
+test('idle pooled iterators expire across all kinds', async function (t) {
+  const db = testCommon.factory({ iteratorPoolIdleTimeout: 50 })
+  await db.open()
+  await db.put('a', '1')
+
+  db.querySync({ ...options, gte: 'a' })
+  db.querySync({ ...options, lt: 'b' })
+  t.is(db.idleIterators, 2, 'one of each kind is pooled')
+
+  await new Promise((resolve) => setTimeout(resolve, 100))
+  db.querySync(options)
+  t.is(db.idleIterators, 1, 'using another kind evicts the expired ones')
+
+  await db.close()
+  t.end()
+})
@@ -0,0 +1,91 @@
+'use strict'
+
+// Coverage for `prefetch: true`, where the next nextv batch is read on the
+// threadpool while the current one is consumed by JS.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+const keys = []
+for (let i = 0; i < 500; i++) keys.push('key' + String(i).padStart(3, '0'))
+
+async function setup () {
+  const db = testCommon.factory()
+  await db.open()
+  const batch = db.batch()
+  for (const key of keys) batch.put(key, 'value')
+  await batch.write()
+  return db
+}
+
+test('prefetching iterators return every entry once', async function (t) {
+  const db = await setup()
+
+  t.same(await db.keys({ prefetch: true }).all(), keys, 'all()')
+
+  const it = db.iterator({ prefetch: true })
+  const seen = []
+  for await (const [key] of it) seen.push(key)
+  t.same(seen, keys, 'next()')
+
+  {
+    const it = db.iterator({ prefetch: true })
+    const seen = []
+    for (const size of [100, 20, 300, 1000]) {
+      for (const [key] of await it.nextv(size)) seen.push(key)
+    }
+    t.same(seen, keys, 'nextv() with varying sizes')
+    await it.close()
+  }
+
+  await db.close()
+  t.end()
+})
+
+test('seek and close while a batch is prefetched', async function (t) {
+  const db = await setup()
+
+  const it = db.iterator({ prefetch: true })
+  t.equal((await it.nextv(10)).length, 10, 'first batch')
+  it.seek('key400')
+  t.same((await it.nextv(2)).map(([key]) => key), ['key400', 'key401'], 'seek discards the prefetched batch')
+
+  await it.nextv(10)
+  await it.close()
+  t.pass('close waits for the prefetch')
+
+  await db.close()
+  t.end()
+})
+
+test('next() after nextv() keeps the rest of a prefetched batch', async function (t) {
+  const db = await setup()
+
+  const it = db.iterator({ prefetch: true })
+  const seen = (await it.nextv(100)).map(([key]) => key)
+  for (let entry = await it.next(); entry !== undefined; entry = await it.next()) {
+    seen.push(entry[0])
+  }
+  t.same(seen, keys, 'no entries are lost')
+
+  await it.close()
+  await db.close()
+  t.end()
+})
+
+test('nextvSync() while a batch is prefetched', async function (t) {
+  const db = await setup()
+
+  const it = db.iterator({ prefetch: true })
+  const seen = (await it.nextv(10)).map(([key]) => key)
+  t.throws(() => it._nextvSync(10, {}), (err) => err.code === 'LEVEL_ITERATOR_BUSY', 'rejected while in flight')
+
+  for (let rows = await it.nextv(100); rows.length > 0; rows = await it.nextv(100)) {
+    for (const [key] of rows) seen.push(key)
+  }
+  t.same(seen, keys, 'the iterator is still usable')
+
+  await it.close()
+  await db.close()
+  t.end()
+})
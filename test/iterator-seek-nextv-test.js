@@ -0,0 +1,71 @@
+'use strict'
+
+// Coverage for deferred seeks: seek() is applied together with the next async
+// read in one iterator_seek_nextv call instead of a separate native seek.
+
+const test = require('tape')
+const testCommon = require('./common')
+const binding = require('../binding')
+
+async function setup () {
+  const db = testCommon.factory()
+  await db.open()
+  const batch = db.batch()
+  for (const k of ['a', 'b', 'c', 'd', 'e']) batch.put(k, 'V' + k)
+  await batch.write()
+  return db
+}
+
+function spy (t, name) {
+  const original = binding[name]
+  const calls = []
+  binding[name] = (...args) => {
+    calls.push(args)
+    return original(...args)
+  }
+  t.teardown(() => { binding[name] = original })
+  return calls
+}
+
+test('seek() then nextv() takes one native call', async function (t) {
+  const db = await setup()
+  const seeks = spy(t, 'iterator_seek_sync')
+  const seekNextv = spy(t, 'iterator_seek_nextv')
+
+  const it = db.iterator({ keyEncoding: 'utf8', valueEncoding: 'utf8' })
+  it.seek('c')
+  t.same(await it.nextv(2), [['c', 'Vc'], ['d', 'Vd']], 'reads from the target')
+  t.is(seekNextv.length, 1, 'combined call')
+  t.is(seeks.length, 0, 'no separate seek')
+
+  it.seek('a')
+  it.seek('b')
+  t.same(await it.nextv(1), [['b', 'Vb']], 'the last seek wins')
+  t.same(await it.nextv(1), [['c', 'Vc']], 'continues after the target')
+  t.is(seekNextv.length, 2)
+
+  it.seek('e')
+  const { rows, finished } = it._nextvSync(5, {})
+  t.same(rows, ['e', 'Ve'], 'sync reads apply the seek first')
+  t.ok(finished)
+  t.is(seeks.length, 1)
+
+  await it.close()
+  await db.close()
+  t.end()
+})
+
+test('deferred seek works with reverse and next()', async function (t) {
+  const db = await setup()
+
+  const it = db.iterator({ reverse: true, keyEncoding: 'utf8', valueEncoding: 'utf8' })
+  it.seek('c')
+  t.same(await it.next(), ['c', 'Vc'])
+  t.same(await it.next(), ['b', 'Vb'])
+
+  it.seek('d')
+  t.same(await it.all(), [['d', 'Vd'], ['c', 'Vc'], ['b', 'Vb'], ['a', 'Va']], 'all()')
+
+  await db.close()
+  t.end()
+})
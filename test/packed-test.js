@@ -0,0 +1,98 @@
+'use strict'
+
+// Coverage for `format: 'packed'`, where a nextv batch comes back as one buffer
+// plus a Uint32Array of offsets and is exposed to JS through a lazy PackedRows
+// view instead of a flat array of per-row buffers/strings.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+const keys = ['a', 'b', 'c', 'd', 'e']
+
+async function setup (options) {
+  const db = testCommon.factory(options)
+  await db.open()
+  const batch = db.batch()
+  for (const k of keys) batch.put(k, 'V' + k)
+  await batch.write()
+  return db
+}
+
+test('packed iterator returns the same entries as the default format', async function (t) {
+  const db = await setup()
+
+  t.same(await db.iterator({ format: 'packed' }).all(), await db.iterator().all(), 'all() matches')
+  t.same(await db.iterator({ format: 'packed', reverse: true, limit: 2 }).all(), [['e', 'Ve'], ['d', 'Vd']], 'reverse + limit')
+
+  const it = db.iterator({ format: 'packed' })
+  const entries = []
+  for await (const entry of it) entries.push(entry)
+  t.same(entries, keys.map((k) => [k, 'V' + k]), 'next() consumes the packed cache')
+
+  await db.close()
+  t.end()
+})
+
+test('packed nextv exposes buffer and offsets', async function (t) {
+  for (const [label, nextv] of [
+    ['sync', (it) => it._nextvSync(1e3, {})],
+    ['async', (it) => it._nextvAsync(1e3, {})]
+  ]) {
+    const db = await setup()
+
+    const it = db.iterator({ format: 'packed', keyEncoding: 'buffer', valueEncoding: 'buffer' })
+    const { rows, buffer, offsets, finished } = await nextv(it)
+    await it.close()
+
+    t.ok(Buffer.isBuffer(buffer), `${label}: buffer is a Buffer`)
+    t.ok(offsets instanceof Uint32Array, `${label}: offsets is a Uint32Array`)
+    t.equal(offsets.length, keys.length * 2 + 1, `${label}: one boundary per key and value, plus one`)
+    t.equal(buffer.toString(), keys.map((k) => k + 'V' + k).join(''), `${label}: keys and values are contiguous`)
+    t.equal(rows.length, keys.length * 2, `${label}: rows has the flat-array length`)
+    t.ok(rows.at(0).equals(Buffer.from('a')), `${label}: keys decode as buffers`)
+    t.ok(rows.at(1).equals(Buffer.from('Va')), `${label}: values decode as buffers`)
+    t.ok(finished, `${label}: finished`)
+
+    await db.close()
+  }
+
+  t.end()
+})
+
+test('packed nextv paginates across the count cap', async function (t) {
+  const db = await setup()
+
+  const it = db.iterator({ format: 'packed' })
+  const all = []
+  while (true) {
+    const { rows, finished, limited } = it._nextvSync(2, {})
+    for (let n = 0; n < rows.length; n += 2) all.push(rows.at(n))
+    if (finished) break
+    t.ok(limited, 'capped batch is limited')
+  }
+  await it.close()
+
+  t.same(all, keys, 'every key returned exactly once, in order')
+
+  await db.close()
+  t.end()
+})
+
+test('packed querySync with keys or values only', async function (t) {
+  const db = await setup()
+
+  {
+    const { rows } = db.querySync({ format: 'packed', values: false, keyEncoding: 'utf8' })
+    t.same([...rows], ['a', undefined, 'b', undefined, 'c', undefined, 'd', undefined, 'e', undefined], 'keys only')
+  }
+
+  {
+    const { rows } = db.querySync({ format: 'packed', keys: false, valueEncoding: 'utf8', gte: 'd' })
+    t.same([...rows], [undefined, 'Vd', undefined, 'Ve'], 'values only')
+  }
+
+  t.throws(() => db.querySync({ format: 'nope' }), 'rejects unknown formats')
+
+  await db.close()
+  t.end()
+})
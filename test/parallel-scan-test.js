@@ -0,0 +1,55 @@
+'use strict'
+
+// Coverage for parallelScan(), which reads sub-ranges split at SST file
+// boundaries with one iterator per shard.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+const keys = []
+for (let i = 0; i < 2000; i++) keys.push('key' + String(i).padStart(4, '0'))
+
+async function setup () {
+  const db = testCommon.factory()
+  await db.open()
+
+  // Several flushed files give the scan split candidates.
+  for (let n = 0; n < keys.length; n += 500) {
+    const batch = db.batch()
+    for (const key of keys.slice(n, n + 500)) batch.put(key, 'value')
+    await batch.write()
+    await db.flushWAL({ sync: true })
+    await db.compactRange({ gte: keys[n], lt: keys[n + 499] })
+  }
+
+  return db
+}
+
+async function collect (iterable) {
+  const entries = []
+  for await (const batch of iterable) entries.push(...batch)
+  return entries.map(([key]) => key)
+}
+
+test('parallelScan returns every key in the range', async function (t) {
+  const db = await setup()
+
+  const splits = db._rangeSplits(4, {})
+  t.ok(splits.length > 1, 'the range is split into several shards')
+  t.same([...splits].sort(), splits, 'splits are in order')
+  t.ok(splits.every((key) => keys.includes(key)), 'splits are keys at file boundaries')
+
+  t.same(await collect(db.parallelScan({ concurrency: 4, batchSize: 100 })), keys, 'ordered')
+  t.same((await collect(db.parallelScan({ concurrency: 4, ordered: false }))).sort(), keys, 'unordered')
+  t.same(await collect(db.parallelScan({ gte: 'key0100', lt: 'key1500' })), keys.slice(100, 1500), 'bounded')
+  t.same(await collect(db.parallelScan({ gt: 'key0100', lte: 'key1500' })), keys.slice(101, 1501), 'exclusive and inclusive bounds')
+  t.same(await collect(db.parallelScan({ limit: 10, batchSize: 3 })), keys.slice(0, 10), 'limit')
+
+  for await (const batch of db.parallelScan({ batchSize: 10 })) {
+    t.equal(batch.length, 10, 'breaking out of the loop closes the shards')
+    break
+  }
+
+  await db.close()
+  t.end()
+})
@@ -0,0 +1,45 @@
+'use strict'
+
+const test = require('tape')
+const testCommon = require('./common')
+
+const keys = ['aa0', 'aa1', 'ab0', 'ab1', 'ab2', 'b', 'ba0', 'ba1']
+
+async function setup (options) {
+  const db = testCommon.factory(options)
+  await db.open()
+  await db.batch(keys.map((key) => ({ type: 'put', key, value: key })))
+  await db.compactRange()
+  await db.put('ab3', 'ab3')
+  await db.put(Buffer.from([0xff, 0xff]), 'ff')
+  return db
+}
+
+for (const [name, options] of [
+  ['fixed prefix extractor', { columns: { default: { prefixExtractor: 'rocksdb.FixedPrefix.2' } } }],
+  ['capped prefix extractor', { columns: { default: { prefixExtractor: 'rocksdb.CappedPrefix.3' } } }],
+  ['no prefix extractor', {}]
+]) {
+  test(`prefix with ${name}`, async function (t) {
+    const db = await setup(options)
+
+    t.same(await db.keys({ prefix: 'ab' }).all(), ['ab0', 'ab1', 'ab2', 'ab3'], 'forward')
+    t.same(await db.keys({ prefix: 'ab', reverse: true }).all(), ['ab3', 'ab2', 'ab1', 'ab0'], 'reverse')
+    t.same(await db.keys({ prefix: 'a' }).all(), ['aa0', 'aa1', 'ab0', 'ab1', 'ab2', 'ab3'], 'shorter than the extractor')
+    t.same(await db.keys({ prefix: 'ab1' }).all(), ['ab1'], 'longer than the extractor')
+    t.same(await db.keys({ prefix: 'ac' }).all(), [], 'no matches')
+    t.same(await db.keys({ prefix: 'ab', gt: 'ab0', lte: 'ab2' }).all(), ['ab1', 'ab2'], 'with bounds')
+    t.same(await db.keys({ prefix: 'ab', lt: 'zz' }).all(), ['ab0', 'ab1', 'ab2', 'ab3'], 'with wider bounds')
+    t.same(await db.keys({ prefix: Buffer.from([0xff]), keyEncoding: 'buffer' }).all(), [Buffer.from([0xff, 0xff])], 'without a successor')
+
+    t.same(db.querySync({ prefix: 'ba', keyEncoding: 'utf8', valueEncoding: 'utf8' }).rows, ['ba0', 'ba0', 'ba1', 'ba1'], 'query')
+    t.is(db.countSync({ prefix: 'ab' }).count, 4, 'count')
+
+    const it = db.keys({ prefix: 'ab' })
+    it.seek('ab2')
+    t.same(await it.all(), ['ab2', 'ab3'], 'seek within the prefix')
+
+    await db.close()
+    t.end()
+  })
+}
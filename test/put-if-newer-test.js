@@ -0,0 +1,44 @@
+'use strict'
+
+const test = require('tape')
+const testCommon = require('./common')
+
+test('putIfNewer writes only newer revisions', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+
+  const body = { valueEncoding: 'utf8', valueSlice: { offset: 1 + '2-a'.length } }
+  const header = { valueEncoding: 'utf8', valueSlice: { lengthPrefix: 1 } }
+
+  t.is(await db.putIfNewer('doc', '2-a', 'two'), true, 'no stored value')
+  t.is(await db.putIfNewer('doc', '1-z', 'one'), false, 'older number')
+  t.is(await db.putIfNewer('doc', '2-a', 'again'), false, 'same revision')
+  t.is(await db.putIfNewer('doc', '02-a', 'padded'), false, 'leading zeros are ignored')
+  t.same(db._getManySync(['doc'], body), ['two'], 'unchanged')
+
+  t.is(await db.putIfNewer('doc', '2-b', 'two b'), true, 'same number, greater id')
+  t.is(await db.putIfNewer('doc', '10-a', 'ten'), true, 'more digits')
+  t.is(await db.putIfNewer('doc', 'INF-a', 'inf'), true, 'INF sorts last')
+  t.is(await db.putIfNewer('doc', '99-a', 'ninety-nine'), false)
+  t.same(db._getManySync(['doc'], header), ['INF-a'], 'revision header')
+
+  await t.rejects(db.putIfNewer('doc', '', 'x'), /Revision must be/, 'empty revision')
+
+  await db.close()
+  await t.rejects(db.putIfNewer('doc', '1-a', 'x'), /Database is not open/)
+  t.end()
+})
+
+test('putIfNewer is atomic across concurrent calls', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+
+  const revs = Array.from({ length: 64 }, (_, n) => `${n + 1}-a`).reverse()
+  const results = await Promise.all(revs.map((rev) => db.putIfNewer('doc', Buffer.from(rev), Buffer.from(rev))))
+
+  t.ok(results.includes(true), 'some calls wrote')
+  t.same(db._getManySync(['doc'], { valueEncoding: 'utf8', valueSlice: { lengthPrefix: 1 } }), ['64-a'], 'max wins')
+
+  await db.close()
+  t.end()
+})
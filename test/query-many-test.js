@@ -0,0 +1,77 @@
+'use strict'
+
+const test = require('tape')
+const testCommon = require('./common')
+
+async function setup (options) {
+  const db = testCommon.factory(options)
+  await db.open()
+  const batch = db.batch()
+  for (const prefix of ['a', 'b', 'c']) {
+    for (let i = 0; i < 5; i++) batch.put(`${prefix}${i}`, `${prefix}${i}!`)
+  }
+  await batch.write()
+  return db
+}
+
+const ranges = [
+  { gte: 'a', lt: 'b', limit: 2 },
+  { gt: 'b1', lte: 'b3' },
+  { gte: 'c', lt: 'd', limit: 2, reverse: true },
+  { gt: 'c4' },
+  { lt: 'a2', reverse: true }
+]
+
+const expected = [
+  ['a0', 'a0!', 'a1', 'a1!'],
+  ['b2', 'b2!', 'b3', 'b3!'],
+  ['c4', 'c4!', 'c3', 'c3!'],
+  [],
+  ['a1', 'a1!', 'a0', 'a0!']
+]
+
+test('queryMany reads every range', async function (t) {
+  const db = await setup()
+  const options = { keyEncoding: 'utf8', valueEncoding: 'utf8' }
+
+  t.same(db.queryManySync(ranges, options), expected, 'sync')
+  t.same(await db.queryMany(ranges, options), expected, 'async')
+
+  const packed = db.queryManySync(ranges, { ...options, format: 'packed' })
+  t.same(packed.map((rows) => [...rows]), expected, 'packed')
+
+  const keys = db.queryManySync(ranges.slice(0, 1), { ...options, values: false })
+  t.same(keys, [['a0', undefined, 'a1', undefined]], 'values: false')
+
+  t.same(db.queryManySync([], options), [], 'no ranges')
+
+  await db.close()
+  t.end()
+})
+
+test('queryMany honours snapshots', async function (t) {
+  const db = await setup()
+  const snapshot = db.snapshot()
+  await db.del('a0')
+
+  const options = { keyEncoding: 'utf8', valueEncoding: 'utf8' }
+  t.same(db.queryManySync(ranges.slice(0, 1), options), [['a1', 'a1!', 'a2', 'a2!']], 'latest')
+  t.same(await db.queryMany(ranges.slice(0, 1), { ...options, snapshot }), [expected[0]], 'snapshot')
+
+  snapshot.close()
+  await db.close()
+  t.end()
+})
+
+test('queryMany ranges cross prefixes of a prefix extractor', async function (t) {
+  const db = await setup({ columns: { default: { prefixExtractor: 'rocksdb.FixedPrefix.1' } } })
+  const options = { keyEncoding: 'utf8', valueEncoding: 'utf8' }
+  const spanning = [{ gt: 'a3', limit: 3 }, { lt: 'b1', limit: 2, reverse: true }]
+  const rows = [['a4', 'a4!', 'b0', 'b0!', 'b1', 'b1!'], ['b0', 'b0!', 'a4', 'a4!']]
+
+  t.same(db.queryManySync(spanning, options), rows, 'sync')
+  t.same(await db.queryMany(spanning, options), rows, 'async')
+
+  await db.close()
+  t.end()
+})
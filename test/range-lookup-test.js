@@ -0,0 +1,30 @@
+'use strict'
+
+const test = require('tape')
+const testCommon = require('./common')
+
+for (const [name, options] of [
+  ['range-lookup', { optimize: 'range-lookup' }],
+  ['range-lookup with a prefix extractor', { optimize: 'range-lookup', prefixExtractor: 'rocksdb.FixedPrefix.2' }],
+  ['range-lookup with another index', { optimize: 'range-lookup', indexType: 'binarySearchWithFirstKey' }]
+]) {
+  test(name, async function (t) {
+    const db = testCommon.factory({ columns: { default: options } })
+    await db.open()
+
+    const keys = []
+    for (let n = 0; n < 1000; n++) {
+      keys.push(String(n).padStart(4, '0'))
+    }
+    await db.batch(keys.map((key) => ({ type: 'put', key, value: key })))
+    await db.compactRange()
+
+    t.same(await db.keys().all(), keys, 'scan')
+    t.same(await db.keys({ gte: '0100', lt: '0110', reverse: true }).all(), keys.slice(100, 110).reverse(), 'range')
+    t.same(await db.keys({ prefix: '05' }).all(), keys.slice(500, 600), 'prefix')
+    t.is(await db.get('0999'), '0999', 'get')
+
+    await db.close()
+    t.end()
+  })
+}
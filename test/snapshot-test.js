@@ -0,0 +1,79 @@
+'use strict'
+
+const test = require('tape')
+const testCommon = require('./common')
+
+test('snapshot reads ignore later writes', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+  await db.batch([{ type: 'put', key: 'a', value: '1' }, { type: 'put', key: 'b', value: '1' }])
+
+  const snapshot = db.snapshot()
+  const sequence = db.sequence
+  t.is(snapshot.sequence, sequence, 'sequence')
+
+  await db.batch([{ type: 'put', key: 'a', value: '2' }, { type: 'del', key: 'b' }, { type: 'put', key: 'c', value: '2' }])
+
+  t.is(await db.get('a', { snapshot }), '1', 'get')
+  t.is(db._getSync('b', { snapshot }), '1', 'getSync')
+  t.same(await db.getMany(['a', 'b', 'c'], { snapshot }), ['1', '1', undefined], 'getMany')
+  t.same(db._getManySync(['a', 'c'], { snapshot }), ['1', undefined], 'getManySync')
+  t.same(await db.iterator({ snapshot }).all(), [['a', '1'], ['b', '1']], 'iterator')
+  t.same(db.querySync({ snapshot, keyEncoding: 'utf8', valueEncoding: 'utf8' }).rows, ['a', '1', 'b', '1'], 'query')
+  t.is((await db.count({ snapshot })).count, 2, 'count')
+  t.is(db.countSync({ snapshot }).count, 2, 'countSync')
+
+  t.same(await db.iterator().all(), [['a', '2'], ['c', '2']], 'reads without it see the latest state')
+
+  snapshot.close()
+  t.ok(snapshot.closed, 'closed')
+  t.throws(() => db.iterator({ snapshot }), /Snapshot is closed/, 'closed snapshots are rejected')
+  snapshot.close()
+
+  await db.close()
+  t.end()
+})
+
+test('snapshot iterator outlives close()', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+  await db.put('a', '1')
+
+  const snapshot = db.snapshot()
+  const it = db.iterator({ snapshot })
+  snapshot.close()
+
+  await db.put('a', '2')
+  t.same(await it.all(), [['a', '1']], 'the iterator keeps its view')
+
+  await db.close()
+  t.end()
+})
+
+test('snapshots are released when the db closes', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+
+  const snapshot = db.snapshot()
+  await db.close()
+
+  t.throws(() => snapshot.sequence, /Snapshot is closed/, 'unusable after close')
+  t.throws(() => db.snapshot(), /Database is not open/)
+  t.end()
+})
+
+test('snapshot rejects invalid options', async function (t) {
+  const db = testCommon.factory()
+  const other = testCommon.factory()
+  await db.open()
+  await other.open()
+
+  const snapshot = other.snapshot()
+  t.throws(() => db.countSync({ snapshot }), /another database/, 'from another db')
+  t.throws(() => db.countSync({ snapshot: {} }), /must be a Snapshot/, 'not a snapshot')
+
+  snapshot.close()
+  await other.close()
+  await db.close()
+  t.end()
+})
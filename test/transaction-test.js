@@ -0,0 +1,129 @@
+'use strict'
+
+const test = require('tape')
+const testCommon = require('./common')
+
+async function setup () {
+  const db = testCommon.factory({ optimisticTransactions: true })
+  await db.open()
+  await db.batch([{ type: 'put', key: 'a', value: '1' }, { type: 'put', key: 'b', value: '1' }])
+  return db
+}
+
+test('transaction reads its own writes and commits them', async function (t) {
+  const db = await setup()
+  const options = { valueEncoding: 'utf8' }
+
+  const tx = db.transaction()
+  tx.put('a', '2').del('b').put('c', '2')
+
+  t.is(tx.getSync('a', options), '2', 'getSync')
+  t.is(await tx.get('b', options), undefined, 'get')
+  t.is(await tx.getForUpdate('c', options), '2', 'getForUpdate')
+  t.is(await db.get('a'), '1', 'not visible outside before commit')
+
+  await tx.commit()
+  t.ok(tx.closed, 'closed by commit')
+  t.throws(() => tx.getSync('a'), /Transaction is closed/)
+
+  t.same(await db.iterator().all(), [['a', '2'], ['c', '2']], 'committed')
+
+  await db.close()
+  t.end()
+})
+
+test('transaction commit fails on a conflicting write', async function (t) {
+  const db = await setup()
+
+  const tx = db.transaction()
+  t.is(tx.getForUpdateSync('a', { valueEncoding: 'utf8' }), '1')
+  tx.put('a', '2')
+
+  await db.put('a', '3')
+
+  try {
+    await tx.commit()
+    t.fail('should have failed')
+  } catch (err) {
+    t.is(err.code, 'LEVEL_BUSY', 'conflict')
+  }
+
+  t.is(await db.get('a'), '3', 'nothing written')
+
+  const other = db.transaction()
+  other.getForUpdateSync('b')
+  other.put('b', '2')
+  await db.put('c', '3')
+  await other.commit()
+  t.is(await db.get('b'), '2', 'writes to other keys do not conflict')
+
+  await db.close()
+  t.end()
+})
+
+test('transaction commit fails with TryAgain past the memtable history', async function (t) {
+  const db = testCommon.factory({ optimisticTransactions: true, maxWriteBufferSizeToMaintain: 1 })
+  await db.open()
+  await db.put('a', '1')
+
+  const tx = db.transaction()
+  tx.getForUpdateSync('a')
+  tx.put('a', '2')
+
+  // Flush a few memtables so the one holding 'a' falls out of the history.
+  for (let i = 0; i < 3; i++) {
+    await db.put('b', String(i))
+    await db.compactRange()
+  }
+
+  try {
+    await tx.commit()
+    t.fail('should have failed')
+  } catch (err) {
+    t.is(err.code, 'LEVEL_TRYAGAIN', 'cannot be validated')
+  }
+
+  t.is(await db.get('a'), '1', 'nothing written')
+
+  const retry = db.transaction()
+  retry.getForUpdateSync('a')
+  retry.put('a', '2')
+  await retry.commit()
+  t.is(await db.get('a'), '2', 'a new transaction succeeds')
+
+  await db.close()
+  t.end()
+})
+
+test('transaction snapshot and rollback', async function (t) {
+  const db = await setup()
+  const options = { valueEncoding: 'utf8' }
+
+  const tx = db.transaction({ snapshot: true })
+  await db.put('a', '2')
+  t.is(tx.getSync('a', options), '1', 'reads use the snapshot')
+
+  tx.put('b', '2')
+  tx.rollback()
+  t.is(tx.getSync('b', options), '1', 'rollback discards writes')
+
+  tx.close()
+  tx.close()
+  t.ok(tx.closed)
+
+  const open = db.transaction()
+  await db.close()
+  t.throws(() => open.getSync('a'), /Transaction is closed/, 'closed with the db')
+  t.end()
+})
+
+test('transaction requires optimisticTransactions', async function (t) {
+  const db = testCommon.factory()
+  await db.open()
+
+  t.throws(() => db.transaction(), (err) => err.code === 'LEVEL_NOT_SUPPORTED')
+
+  await db.close()
+  t.throws(() => db.transaction(), /Database is not open/)
+  t.end()
+})
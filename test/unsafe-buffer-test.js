@@ -73,6 +73,95 @@ test('unsafe iterator nextv returns correct values', async function (t) {
   t.end()
 })
 
+test('pinned unsafe iteration outlives the iterator and the db', async function (t) {
+  const db = testCommon.factory({ keyEncoding: 'buffer', valueEncoding: 'buffer' })
+  await db.open()
+
+  const batch = db.batch()
+  for (let i = 0; i < 100; i++) {
+    batch.put(Buffer.from('k' + String(i).padStart(3, '0')), Buffer.alloc(4096, i & 0xff))
+  }
+  await batch.write()
+  await db.compactRange()
+
+  for (const [label, unsafe] of [['pinned', true], ['copied', false]]) {
+    const it = db.iterator({ unsafe, pinData: true })
+    const sync = it._nextvSync(50, {}).rows
+    const async = (await it._nextvAsync(1000, {})).rows
+    await it.close()
+
+    const rows = [...sync, ...async]
+    let ok = rows.length === 200
+    for (let i = 0; i < rows.length; i += 2) {
+      if (!rows[i + 1].equals(Buffer.alloc(4096, (i / 2) & 0xff))) ok = false
+    }
+    t.ok(ok, `${label}: values remain valid after the iterator is closed`)
+  }
+
+  const unpinned = db.iterator({ unsafe: true })
+  await unpinned._nextvAsync(10, {})
+  unpinned._refreshSync()
+  t.pass('unsafe alone does not pin, so refresh works')
+  await unpinned.close()
+
+  const it = db.iterator({ unsafe: true, pinData: true })
+  let retained = (await it._nextvAsync(1000, {})).rows
+  t.throws(() => it._refreshSync(), /pinned buffers/, 'refresh is rejected while pinned buffers are alive')
+  await it.close()
+
+  try {
+    await db.close()
+    t.fail('should have been refused')
+  } catch (err) {
+    t.is(err.cause?.code, 'LEVEL_BUSY', 'close is refused while pinned buffers are alive')
+  }
+  t.is(db.status, 'open', 'still open')
+  t.ok(retained[1].equals(Buffer.alloc(4096, 0)), 'values remain valid')
+
+  if (global.gc) {
+    retained = null
+    global.gc()
+    await new Promise((resolve) => setImmediate(resolve))
+    await db.close()
+    t.is(db.status, 'closed', 'closes once they are collected')
+  }
+
+  t.end()
+})
+
+test('a refused close leaves snapshots and transactions usable', async function (t) {
+  const db = testCommon.factory({ keyEncoding: 'utf8', valueEncoding: 'utf8', optimisticTransactions: true })
+  await db.open()
+  await db.put('a', '1')
+  await db.compactRange()
+
+  const snapshot = db.snapshot()
+  const transaction = db.transaction()
+  transaction.put('b', '2')
+
+  const it = db.iterator({ unsafe: true, pinData: true, valueEncoding: 'buffer' })
+  const retained = (await it._nextvAsync(10, {})).rows
+  await it.close()
+
+  await db.put('a', '2')
+
+  try {
+    await db.close()
+    t.fail('should have been refused')
+  } catch (err) {
+    t.is(err.cause?.code, 'LEVEL_BUSY', 'close is refused')
+  }
+
+  t.is(await db.get('a', { snapshot }), '1', 'the snapshot still reads')
+  t.is(transaction.getSync('b', { valueEncoding: 'utf8' }), '2', 'the transaction keeps its writes')
+  await transaction.commit()
+  t.is(await db.get('b'), '2', 'and commits')
+  t.is(String(retained[1]), '1', 'pinned values remain valid')
+
+  snapshot.close()
+  t.end()
+})
+
 test('unsafe with empty values', async function (t) {
   const db = testCommon.factory({ keyEncoding: 'buffer', valueEncoding: 'buffer' })
   await db.open()
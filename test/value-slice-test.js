@@ -0,0 +1,64 @@
+'use strict'
+
+// Coverage for `valueSlice`, which returns only part of each value from
+// iterators and getMany.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+function prefixed (header, body) {
+  return Buffer.concat([Buffer.from([header.length]), Buffer.from(header), Buffer.from(body)])
+}
+
+async function setup () {
+  const db = testCommon.factory()
+  await db.open()
+  await db.batch([
+    { type: 'put', key: 'a', value: prefixed('12-x', 'body of a') },
+    { type: 'put', key: 'b', value: prefixed('7-yy', 'b') },
+    { type: 'put', key: 'c', value: Buffer.alloc(0) }
+  ])
+  return db
+}
+
+test('iterator valueSlice', async function (t) {
+  const db = await setup()
+  const options = { valueEncoding: 'utf8' }
+
+  const range = await db.values({ ...options, valueSlice: { offset: 1, length: 2 } }).all()
+  t.same(range, ['12', '7-', ''], 'offset and length')
+
+  const header = await db.values({ ...options, valueSlice: { lengthPrefix: 1 } }).all()
+  t.same(header, ['12-x', '7-yy', ''], 'length-prefixed field')
+
+  const rest = await db.values({ ...options, valueSlice: { offset: 5 } }).all()
+  t.same(rest, ['body of a', 'b', ''], 'offset only')
+
+  const packed = db.querySync({ ...options, valueSlice: { lengthPrefix: 1 }, format: 'packed' })
+  t.same([...packed.rows].filter((_, n) => n % 2), ['12-x', '7-yy', ''], 'packed')
+
+  const unsafe = await db.values({ valueSlice: { lengthPrefix: 1 }, unsafe: true }).all()
+  t.same(unsafe.map(String), ['12-x', '7-yy', ''], 'unsafe')
+
+  t.is(db.countSync({ valueSlice: { offset: 1, length: 2 } }).valueBytes, 4, 'count sums projected bytes')
+
+  t.throws(() => db.querySync({ valueSlice: { lengthPrefix: 3 } }), 'rejects other prefix widths')
+
+  await db.close()
+  t.end()
+})
+
+test('getMany valueSlice', async function (t) {
+  const db = await setup()
+  const options = { valueEncoding: 'utf8', valueSlice: { lengthPrefix: 1 } }
+  const expected = ['12-x', undefined, '7-yy', '']
+
+  t.same(db._getManySync(['a', 'missing', 'b', 'c'], options), expected, 'sync')
+  t.same(await db._getManyAsync(['a', 'missing', 'b', 'c'], options), expected, 'async')
+
+  const packed = db._getManySync(['a', 'missing', 'b', 'c'], { ...options, format: 'packed' })
+  t.same([...packed], expected, 'packed')
+
+  await db.close()
+  t.end()
+})
@@ -0,0 +1,65 @@
+'use strict'
+
+// Coverage for the `where` option, a JSON predicate evaluated natively on
+// values during iteration, query and count.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+const docs = {
+  a: { status: 'active', rev: 12, meta: { owner: 'alice' }, tags: ['x', 'y'] },
+  b: { status: 'active', rev: 3, meta: { owner: 'bob' } },
+  c: { status: 'deleted', rev: 40, meta: { owner: 'alice' }, tags: ['z'] },
+  d: { status: 'actïve', rev: 7, deleted: null },
+  e: 'not json'
+}
+
+let db
+
+test('where setup', async function (t) {
+  db = testCommon.factory()
+  await db.open()
+  await db.batch(Object.entries(docs).map(([key, value]) => ({
+    type: 'put',
+    key,
+    value: typeof value === 'string' ? value : JSON.stringify(value)
+  })))
+})
+
+async function keys (where, options) {
+  return db.keys({ where, ...options }).all()
+}
+
+test('where - equality and ranges', async function (t) {
+  t.same(await keys({ path: 'status', eq: 'active' }), ['a', 'b'])
+  t.same(await keys({ path: 'status', ne: 'active' }), ['c', 'd', 'e'], 'ne matches missing fields')
+  t.same(await keys({ path: 'rev', gte: 7, lt: 40 }), ['a', 'd'], 'several operators on one path')
+  t.same(await keys({ path: 'status', eq: 'actïve' }), ['d'], 'non-ascii strings')
+  t.same(await keys({ path: 'deleted', eq: null }), ['d'], 'null')
+  t.same(await keys({ path: 'rev', eq: '12' }), [], 'types do not coerce')
+})
+
+test('where - nested paths and arrays', async function (t) {
+  t.same(await keys({ path: 'meta.owner', eq: 'alice' }), ['a', 'c'])
+  t.same(await keys({ path: ['meta', 'owner'], eq: 'bob' }), ['b'], 'array path')
+  t.same(await keys({ path: 'tags.1', eq: 'y' }), ['a'], 'array index')
+  t.same(await keys({ path: 'tags', exists: true }), ['a', 'c'])
+  t.same(await keys({ path: 'tags', exists: false }), ['b', 'd', 'e'])
+})
+
+test('where - conditions combine', async function (t) {
+  const where = [{ path: 'meta.owner', eq: 'alice' }, { path: 'status', eq: 'active' }]
+  t.same(await keys(where), ['a'])
+  t.same(await keys(where, { keyFilter: '^b' }), [], 'with keyFilter')
+  t.is(db.countSync({ where: { path: 'status', eq: 'active' } }).count, 2, 'count')
+  t.same(db.querySync({ where, keyEncoding: 'utf8', valueEncoding: 'utf8' }).rows, ['a', JSON.stringify(docs.a)], 'query')
+})
+
+test('where - rejects invalid conditions', async function (t) {
+  t.throws(() => db.querySync({ where: { path: 'status' } }), 'no operator')
+  t.throws(() => db.querySync({ where: { path: 'status', eq: {} } }), 'object operand')
+})
+
+test('where teardown', async function (t) {
+  await db.close()
+})
@@ -0,0 +1,37 @@
+'use strict'
+
+// Coverage for the opt-in `coalesceWrites` mode, where puts and dels issued in
+// the same tick share one WriteBatch per write options.
+
+const test = require('tape')
+const testCommon = require('./common')
+
+test('coalesced writes resolve individually', async function (t) {
+  const db = testCommon.factory({ coalesceWrites: true })
+  await db.open()
+
+  const keys = []
+  for (let i = 0; i < 100; i++) keys.push('key' + i)
+
+  const before = db.sequence
+  await Promise.all(keys.map((key) => db.put(key, 'value')))
+  t.equal(db.sequence - before, keys.length, 'every put was written')
+  t.same(await db.getMany(keys), keys.map(() => 'value'), 'values are readable')
+
+  await Promise.all([db.del('key0'), db.put('key1', 'other', { sync: true })])
+  t.same(await db.getMany(['key0', 'key1']), [undefined, 'other'], 'sync and non-sync writes are split and both applied')
+
+  // A column that is not a handle fails in batch_put, inside the coalesced path.
+  const results = await Promise.allSettled([db.put('key2', 'v2'), db.put('key3', 'v3', { column: {} }), db.del('key4')])
+  t.equal(results[0].status, 'fulfilled', 'valid write succeeds')
+  t.equal(results[1].status, 'rejected', 'invalid write fails alone')
+  t.equal(results[2].status, 'fulfilled', 'later write in the same batch succeeds')
+  t.same(await db.getMany(['key2', 'key3', 'key4']), ['v2', undefined, undefined], 'only valid writes are applied')
+
+  const pending = db.put('key4', 'v4')
+  await db.close()
+  await pending
+  t.pass('close waits for a queued write')
+
+  t.end()
+})
@@ -0,0 +1,145 @@
+'use strict'
+
+const { fromCallback } = require('catering')
+const ModuleError = require('module-error')
+const binding = require('./binding')
+const { kRef, kUnref } = require('./util')
+
+const kPromise = Symbol('promise')
+const kContext = Symbol('context')
+const kDB = Symbol('db')
+const kBusy = Symbol('busy')
+
+const EMPTY = {}
+const FOR_UPDATE = Object.freeze({ forUpdate: true })
+
+// An optimistic transaction, from db.transaction() on a db opened with
+// `optimisticTransactions`. Writes are buffered and visible to its own reads
+// until commit(), which fails with LEVEL_BUSY if a key read by getForUpdate()
+// was written by someone else in the meantime, or with LEVEL_TRYAGAIN if the
+// writes since the transaction began no longer fit the memtable history (see
+// the `maxWriteBufferSizeToMaintain` option). Both are retryable. Reads run on
+// the calling thread; commit() runs on the threadpool. Rolled back by close()
+// if not committed, and closed when the db closes.
+class Transaction {
+  constructor (db, context, options) {
+    this[kDB] = db
+    this[kContext] = binding.transaction_init(context, options ?? EMPTY)
+    this[kBusy] = false
+  }
+
+  get closed () {
+    return this[kContext] === null
+  }
+
+  get (key, options, callback) {
+    callback = fromCallback(callback, kPromise)
+
+    try {
+      process.nextTick(callback, null, this.getSync(key, options))
+    } catch (err) {
+      process.nextTick(callback, err)
+    }
+
+    return callback[kPromise]
+  }
+
+  getSync (key, options) {
+    return binding.transaction_get_sync(this._context(), key, options ?? EMPTY)
+  }
+
+  // Like get(), but the key is checked for conflicting writes at commit.
+  getForUpdate (key, options, callback) {
+    callback = fromCallback(callback, kPromise)
+
+    try {
+      process.nextTick(callback, null, this.getForUpdateSync(key, options))
+    } catch (err) {
+      process.nextTick(callback, err)
+    }
+
+    return callback[kPromise]
+  }
+
+  getForUpdateSync (key, options) {
+    return binding.transaction_get_sync(this._context(), key, options ? { ...options, forUpdate: true } : FOR_UPDATE)
+  }
+
+  put (key, value, options) {
+    binding.transaction_put(this._context(), key, value, options ?? EMPTY)
+    return this
+  }
+
+  del (key, options) {
+    binding.transaction_del(this._context(), key, options ?? EMPTY)
+    return this
+  }
+
+  merge (key, value, options) {
+    binding.transaction_merge(this._context(), key, value, options ?? EMPTY)
+    return this
+  }
+
+  // Writes the transaction and closes it, whether or not it succeeds. On
+  // LEVEL_BUSY or LEVEL_TRYAGAIN nothing is written; start a new transaction
+  // to retry.
+  commit (callback) {
+    callback = fromCallback(callback, kPromise)
+
+    const db = this[kDB]
+
+    try {
+      const context = this._context()
+      this[kBusy] = true
+      db[kRef]()
+      binding.transaction_commit(context, (err) => {
+        this[kBusy] = false
+        this.close()
+        db[kUnref]()
+        callback(err)
+      })
+    } catch (err) {
+      if (this[kBusy]) {
+        this[kBusy] = false
+        db[kUnref]()
+      }
+      process.nextTick(callback, err)
+    }
+
+    return callback[kPromise]
+  }
+
+  // Discards the buffered writes. The transaction stays usable.
+  rollback () {
+    binding.transaction_rollback(this._context())
+  }
+
+  close () {
+    if (this[kContext] !== null && !this[kBusy]) {
+      binding.transaction_close(this[kContext])
+      this[kContext] = null
+    }
+  }
+
+  [Symbol.dispose] () {
+    this.close()
+  }
+
+  _context () {
+    if (this[kBusy]) {
+      throw new ModuleError('Transaction is being committed', {
+        code: 'LEVEL_TRANSACTION_BUSY'
+      })
+    }
+
+    if (this[kContext] === null || this[kDB].status !== 'open') {
+      throw new ModuleError('Transaction is closed', {
+        code: 'LEVEL_TRANSACTION_CLOSED'
+      })
+    }
+
+    return this[kContext]
+  }
+}
+
+exports.Transaction = Transaction
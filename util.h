@@ -11,7 +11,9 @@
 #include <array>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 #define NAPI_STATUS_RETURN(call) \
   {                              \
@@ -85,6 +87,8 @@ static napi_value ToError(napi_env env, const rocksdb::Status& status) {
     return CreateError(env, "LEVEL_CORRUPTION", msg);
   } else if (status.IsTryAgain()) {
     return CreateError(env, "LEVEL_TRYAGAIN", msg);
+  } else if (status.IsBusy()) {
+    return CreateError(env, "LEVEL_BUSY", msg);
   } else if (status.IsIOError()) {
     if (msg.find("IO error: lock ") != std::string::npos) {  // env_posix.cc
       return CreateError(env, "LEVEL_LOCKED", msg);
@@ -203,8 +207,40 @@ static napi_status GetString(napi_env env, napi_value from, rocksdb::PinnableSli
   return napi_ok;
 }
 
+// Encodes UTF-16 code units as UTF-8 the way Buffer.from(string) does, i.e. a
+// lone surrogate becomes U+FFFD.
+static void AppendUtf8(std::string& to, const char16_t* data, size_t length) {
+  for (size_t n = 0; n < length; n++) {
+    uint32_t c = data[n];
+
+    if (c >= 0xD800 && c <= 0xDBFF && n + 1 < length && data[n + 1] >= 0xDC00 && data[n + 1] <= 0xDFFF) {
+      c = 0x10000 + ((c - 0xD800) << 10) + (data[++n] - 0xDC00);
+    } else if (c >= 0xD800 && c <= 0xDFFF) {
+      c = 0xFFFD;
+    }
+
+    if (c < 0x80) {
+      to.push_back(static_cast<char>(c));
+    } else if (c < 0x800) {
+      to.push_back(static_cast<char>(0xC0 | (c >> 6)));
+      to.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else if (c < 0x10000) {
+      to.push_back(static_cast<char>(0xE0 | (c >> 12)));
+      to.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+      to.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else {
+      to.push_back(static_cast<char>(0xF0 | (c >> 18)));
+      to.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+      to.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+      to.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    }
+  }
+}
+
 enum class Encoding { Invalid, Buffer, String };
 
+enum class Format { Rows, Packed };
+
 static napi_status GetValue(napi_env env, napi_value value, bool& result) {
   return napi_get_value_bool(env, value, &result);
 }
@@ -260,6 +296,29 @@ static napi_status GetValue(napi_env env, napi_value value, std::string& result)
   return GetString(env, value, result);
 }
 
+// A single string or buffer, or an array of them.
+static napi_status GetValue(napi_env env, napi_value value, std::vector<std::string>& result) {
+  bool isArray = false;
+  NAPI_STATUS_RETURN(napi_is_array(env, value, &isArray));
+
+  if (!isArray) {
+    result.resize(1);
+    return GetString(env, value, result[0]);
+  }
+
+  uint32_t length;
+  NAPI_STATUS_RETURN(napi_get_array_length(env, value, &length));
+
+  result.resize(length);
+  for (uint32_t n = 0; n < length; n++) {
+    napi_value element;
+    NAPI_STATUS_RETURN(napi_get_element(env, value, n, &element));
+    NAPI_STATUS_RETURN(GetString(env, element, result[n]));
+  }
+
+  return napi_ok;
+}
+
 static napi_status GetValue(napi_env env, napi_value value, rocksdb::PinnableSlice& result) {
   return GetString(env, value, result);
 }
@@ -291,6 +350,43 @@ static napi_status GetValue(napi_env env, napi_value value, Encoding& result) {
   return napi_invalid_arg;
 }
 
+static napi_status GetValue(napi_env env, napi_value value, Format& result) {
+  std::string str;
+  NAPI_STATUS_RETURN(GetString(env, value, str));
+
+  if (str == "rows") {
+    result = Format::Rows;
+    return napi_ok;
+  } else if (str == "packed") {
+    result = Format::Packed;
+    return napi_ok;
+  }
+
+  return napi_invalid_arg;
+}
+
+static napi_status GetValue(napi_env env, napi_value value, std::span<char>& result) {
+  char* buf = nullptr;
+  size_t length = 0;
+  NAPI_STATUS_RETURN(napi_get_buffer_info(env, value, reinterpret_cast<void**>(&buf), &length));
+  result = {buf, length};
+  return napi_ok;
+}
+
+static napi_status GetValue(napi_env env, napi_value value, std::span<uint32_t>& result) {
+  napi_typedarray_type type;
+  size_t length = 0;
+  void* data = nullptr;
+  NAPI_STATUS_RETURN(napi_get_typedarray_info(env, value, &type, &length, &data, nullptr, nullptr));
+
+  if (type != napi_uint32_array) {
+    return napi_invalid_arg;
+  }
+
+  result = {static_cast<uint32_t*>(data), length};
+  return napi_ok;
+}
+
 static napi_status GetValue(napi_env env,
                             napi_value value,
                             rocksdb::BlockBasedTableOptions::PrepopulateBlockCache& result) {
@@ -462,6 +558,30 @@ napi_status Convert(napi_env env,
   }
 }
 
+// Hands a worker-filled slab to JS as a Buffer without copying it. As with the
+// unsafe PinnableSlice path above, ownership only moves to the finalizer once
+// the external buffer was created successfully.
+static napi_status ConvertExternal(napi_env env, std::string&& data, napi_value& result) {
+  auto data2 = std::make_unique<std::string>(std::move(data));
+  const auto status = napi_create_external_buffer(env, data2->size(), data2->data(), Finalize<std::string>,
+                                                  data2.get(), &result);
+  if (status == napi_ok) {
+    data2.release();
+  }
+  return status;
+}
+
+static napi_status ConvertExternal(napi_env env, std::vector<uint32_t>&& data, napi_value& result) {
+  auto data2 = std::make_unique<std::vector<uint32_t>>(std::move(data));
+
+  napi_value arrayBuffer;
+  NAPI_STATUS_RETURN(napi_create_external_arraybuffer(env, data2->data(), data2->size() * sizeof(uint32_t),
+                                                      Finalize<std::vector<uint32_t>>, data2.get(), &arrayBuffer));
+  auto data3 = data2.release();
+
+  return napi_create_typedarray(env, napi_uint32_array, data3->size(), arrayBuffer, 0, &result);
+}
+
 class Reference {
   Reference(napi_env env, napi_ref ref) : env_(env), ref_(ref) {}
 
@@ -475,6 +595,8 @@ class Reference {
 
   Reference() = default;
 
+  napi_status Get(napi_value& result) const { return napi_get_reference_value(env_, ref_, &result); }
+
   ~Reference() {
     if (ref_) {
       napi_delete_reference(env_, ref_);